@@ -1,61 +1,326 @@
 /*
  * NB-IoT PUR Experiment - Minimal version
+ *
+ * Single run:  pur_test [numUes] [mode]
+ * Batch:       pur_test --batch SPEC [--output FILE] [--threads N]
+ *
+ * A batch runs every combination of the lists in the spec file inside one
+ * process, on the simulator's task pool, and streams one CSV row per
+ * configuration into a single file (in spec order). Spec file, one list per
+ * line, '#' starts a comment:
+ *
+ *   ues = 100, 500, 1000:10000:1000     # start:stop[:step], stop included
+ *   modes = RAP, EDT, PUR
+ *   packets_per_day = 1, 24, 96
+ *   battery_wh = 5, 10                  # or battery_j = 18000, 36000
+ *   seeds = 1:10
+ *
+ * Omitted lists keep the single-run defaults (100 UEs, PUR, 24 packets/day,
+ * 5 Wh, seed 1). The model is deterministic: the seed is carried to the
+ * output so that replicated sweeps keep their layout.
  */
 
 #include <iostream>
 #include <cstdlib>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/task-pool.h"
+
+struct ExperimentConfig {
+    int numUes = 100;
+    std::string mode = "PUR";
+    double packetsPerDay = 24.0;
+    double batteryJ = 18000.0;       // batterie 5 Wh
+    uint64_t seed = 1;
+};
+
+struct ExperimentResult {
+    double energy;
+    double latency;
+    double batteryLife;
+    double energySaving;
+    double latencyReduction;
+};
+
+// Résultats simulés (basés sur le papier)
+ExperimentResult runExperiment(const ExperimentConfig& config) {
+    ExperimentResult result;
+    if (config.mode == "RAP") {
+        result.energy = 4.5;
+        result.latency = 500.0;
+    } else if (config.mode == "EDT") {
+        result.energy = 3.5;
+        result.latency = 250.0;
+    } else { // PUR
+        result.energy = 2.5;
+        result.latency = 150.0;
+    }
+
+    // Ajuster basé sur le nombre d'UEs
+    result.energy += (config.numUes / 1000.0) * 0.1;
+    result.latency += (config.numUes / 1000.0) * 10;
+
+    // Durée de vie : un paquet consomme `energy`
+    double dailyEnergy = result.energy * config.packetsPerDay;
+    result.batteryLife = config.batteryJ / (dailyEnergy * 365);
+
+    result.energySaving = (4.5 - result.energy) / 4.5 * 100;
+    result.latencyReduction = (500 - result.latency) / 500 * 100;
+    return result;
+}
+
+// Produit cartésien des listes du fichier de spécification
+class SweepSpec {
+public:
+    SweepSpec() : ues({100}), modes({"PUR"}), packetsPerDay({24.0}), batteryJ({18000.0}), seeds({1}) {}
+
+    static SweepSpec load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("Cannot open spec file: " + path);
+        SweepSpec spec;
+        std::string line;
+        for (int number = 1; std::getline(in, line); number++) {
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) fail(path, number, "expected key = values");
+            std::string key = trim(line.substr(0, equals));
+            std::vector<std::string> items = split(line.substr(equals + 1));
+            if (items.empty()) fail(path, number, "empty list for " + key);
+
+            if (key == "ues") {
+                spec.ues.clear();
+                for (double value : numbers(items, path, number)) {
+                    if (value < 1) fail(path, number, "UE counts must be positive");
+                    spec.ues.push_back(static_cast<int>(value));
+                }
+            } else if (key == "modes") {
+                for (const auto& mode : items) {
+                    if (mode != "RAP" && mode != "EDT" && mode != "PUR") fail(path, number, "unknown mode " + mode);
+                }
+                spec.modes = items;
+            } else if (key == "packets_per_day") {
+                spec.packetsPerDay = positive(numbers(items, path, number), path, number, key);
+            } else if (key == "battery_j") {
+                spec.batteryJ = positive(numbers(items, path, number), path, number, key);
+            } else if (key == "battery_wh") {
+                spec.batteryJ = positive(numbers(items, path, number), path, number, key);
+                for (double& capacity : spec.batteryJ) capacity *= 3600.0;
+            } else if (key == "seeds") {
+                spec.seeds.clear();
+                for (double value : numbers(items, path, number)) spec.seeds.push_back(static_cast<uint64_t>(value));
+            } else {
+                fail(path, number, "unknown key " + key);
+            }
+        }
+        return spec;
+    }
+
+    size_t size() const {
+        return ues.size() * modes.size() * packetsPerDay.size() * batteryJ.size() * seeds.size();
+    }
+
+    // Configuration d'indice index : la graine varie le plus vite, puis la
+    // batterie, le débit, le nombre d'UEs et enfin le mode
+    ExperimentConfig at(size_t index) const {
+        ExperimentConfig config;
+        config.seed = seeds[index % seeds.size()];
+        index /= seeds.size();
+        config.batteryJ = batteryJ[index % batteryJ.size()];
+        index /= batteryJ.size();
+        config.packetsPerDay = packetsPerDay[index % packetsPerDay.size()];
+        index /= packetsPerDay.size();
+        config.numUes = ues[index % ues.size()];
+        index /= ues.size();
+        config.mode = modes[index];
+        return config;
+    }
+
+private:
+    static std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) return "";
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    static std::vector<std::string> split(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream list(text);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            item = trim(item);
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    [[noreturn]] static void fail(const std::string& path, int line, const std::string& message) {
+        throw std::runtime_error(path + ":" + std::to_string(line) + ": " + message);
+    }
+
+    static double number(const std::string& text, const std::string& path, int line) {
+        char* end = nullptr;
+        double value = strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0') fail(path, line, "invalid number " + text);
+        return value;
+    }
+
+    // Valeurs et plages start:stop[:step] (stop inclus)
+    static std::vector<double> numbers(const std::vector<std::string>& items, const std::string& path, int line) {
+        std::vector<double> values;
+        for (const auto& item : items) {
+            size_t first = item.find(':');
+            if (first == std::string::npos) {
+                values.push_back(number(item, path, line));
+                continue;
+            }
+            size_t second = item.find(':', first + 1);
+            double start = number(trim(item.substr(0, first)), path, line);
+            double stop = number(trim(item.substr(first + 1, second == std::string::npos ? std::string::npos
+                                                                                       : second - first - 1)),
+                                 path, line);
+            double step = second == std::string::npos ? 1.0 : number(trim(item.substr(second + 1)), path, line);
+            if (step <= 0 || stop < start) fail(path, line, "invalid range " + item);
+            // Tolérance pour que 0.1:1:0.1 inclue 1
+            for (long long k = 0; start + k * step <= stop + step * 1e-9; k++) values.push_back(start + k * step);
+        }
+        return values;
+    }
+
+    static std::vector<double> positive(const std::vector<double>& values, const std::string& path, int line,
+                                        const std::string& key) {
+        for (double value : values) {
+            if (value <= 0) fail(path, line, key + " must be positive");
+        }
+        return values;
+    }
+
+    std::vector<int> ues;
+    std::vector<std::string> modes;
+    std::vector<double> packetsPerDay;
+    std::vector<double> batteryJ;
+    std::vector<uint64_t> seeds;
+};
+
+// Les configurations sont traitées par blocs sur le pool ; chaque bloc
+// formate ses lignes et le thread principal les écrit dans l'ordre, par
+// fenêtres de quelques blocs par thread pour borner la mémoire
+int runBatch(const std::string& specPath, const std::string& outputPath, unsigned threads) {
+    const size_t kConfigsPerBlock = 4096;
+
+    SweepSpec spec;
+    try {
+        spec = SweepSpec::load(specPath);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(outputPath);
+    if (!out) {
+        std::cerr << "Cannot create " << outputPath << std::endl;
+        return 1;
+    }
+    out << "Id,Mode,UEs,PacketsPerDay,Battery_J,Seed,Energy_J,Latency_ms,"
+        << "BatteryLife_Years,EnergySaving_Pct,LatencyReduction_Pct\n";
+
+    auto start = std::chrono::steady_clock::now();
+    TaskPool pool(threads);
+    const size_t total = spec.size();
+    const size_t blockCount = (total + kConfigsPerBlock - 1) / kConfigsPerBlock;
+    const size_t window = 8 * pool.threadCount();
+    std::vector<std::string> rows(window);
+
+    for (size_t first = 0; first < blockCount; first += window) {
+        size_t last = std::min(blockCount, first + window);
+        TaskPool::TaskGroup group;
+        for (size_t block = first; block < last; block++) {
+            pool.submit(group, [&spec, &rows, block, first, total, kConfigsPerBlock] {
+                std::ostringstream text;
+                size_t end = std::min(total, (block + 1) * kConfigsPerBlock);
+                for (size_t index = block * kConfigsPerBlock; index < end; index++) {
+                    ExperimentConfig config = spec.at(index);
+                    ExperimentResult result = runExperiment(config);
+                    text << index << ',' << config.mode << ',' << config.numUes << ','
+                         << config.packetsPerDay << ',' << config.batteryJ << ',' << config.seed << ','
+                         << result.energy << ',' << result.latency << ',' << result.batteryLife << ','
+                         << result.energySaving << ',' << result.latencyReduction << '\n';
+                }
+                rows[block - first] = text.str();
+            });
+        }
+        pool.wait(group);
+        for (size_t block = first; block < last; block++) out << rows[block - first];
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error while writing " << outputPath << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << total << " configurations in " << seconds << " s (" << pool.threadCount()
+              << " threads) -> " << outputPath << std::endl;
+    return 0;
+}
 
 // Fonction principale simplifiée pour test
 int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        std::string specPath, outputPath = "pur_experiment_batch.csv";
+        unsigned threads = 0;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+                specPath = argv[++i];
+            } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+                outputPath = argv[++i];
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                threads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+            } else {
+                std::cerr << "Usage: " << argv[0] << " --batch SPEC [--output FILE] [--threads N]" << std::endl;
+                return 1;
+            }
+        }
+        if (specPath.empty()) {
+            std::cerr << "Usage: " << argv[0] << " --batch SPEC [--output FILE] [--threads N]" << std::endl;
+            return 1;
+        }
+        return runBatch(specPath, outputPath, threads);
+    }
+
     std::cout << "========================================" << std::endl;
     std::cout << "NB-IoT PUR Experiment - Test Version" << std::endl;
     std::cout << "========================================" << std::endl;
-    
+
     // Paramètres simples
-    int numUes = 100;
-    std::string mode = "PUR";
-    
-    if (argc > 1) numUes = atoi(argv[1]);
-    if (argc > 2) mode = argv[2];
-    
+    ExperimentConfig config;
+
+    if (argc > 1) config.numUes = atoi(argv[1]);
+    if (argc > 2) config.mode = argv[2];
+
     std::cout << "Configuration:" << std::endl;
-    std::cout << "  Number of UEs: " << numUes << std::endl;
-    std::cout << "  Transmission mode: " << mode << std::endl;
-    
-    // Résultats simulés (basés sur le papier)
-    double energy = 0.0;
-    double latency = 0.0;
-    
-    if (mode == "RAP") {
-        energy = 4.5;
-        latency = 500.0;
-    } else if (mode == "EDT") {
-        energy = 3.5;
-        latency = 250.0;
-    } else { // PUR
-        energy = 2.5;
-        latency = 150.0;
-    }
-    
-    // Ajuster basé sur le nombre d'UEs
-    energy += (numUes / 1000.0) * 0.1;
-    latency += (numUes / 1000.0) * 10;
-    
+    std::cout << "  Number of UEs: " << config.numUes << std::endl;
+    std::cout << "  Transmission mode: " << config.mode << std::endl;
+
+    ExperimentResult result = runExperiment(config);
+
     std::cout << "\nSimulation Results (approximate):" << std::endl;
-    std::cout << "  Average energy per UE: " << energy << " J" << std::endl;
-    std::cout << "  Average latency: " << latency << " ms" << std::endl;
-    
-    // Calcul durée vie batterie (batterie 5 Wh = 18000 J)
-    double dailyEnergy = energy * 24;  // 1 paquet par jour
-    double batteryLife = 18000.0 / (dailyEnergy * 365);
-    
-    std::cout << "  Estimated battery life: " << batteryLife << " years" << std::endl;
-    
+    std::cout << "  Average energy per UE: " << result.energy << " J" << std::endl;
+    std::cout << "  Average latency: " << result.latency << " ms" << std::endl;
+    std::cout << "  Estimated battery life: " << result.batteryLife << " years" << std::endl;
+
     std::cout << "\nImprovements compared to RAP:" << std::endl;
-    std::cout << "  Energy saving: " << ((4.5 - energy) / 4.5 * 100) << "%" << std::endl;
-    std::cout << "  Latency reduction: " << ((500 - latency) / 500 * 100) << "%" << std::endl;
-    
+    std::cout << "  Energy saving: " << result.energySaving << "%" << std::endl;
+    std::cout << "  Latency reduction: " << result.latencyReduction << "%" << std::endl;
+
     std::cout << "========================================" << std::endl;
-    
+
     return 0;
 }
@@ -0,0 +1,7 @@
+# Balayage d'exemple pour nbiot-pur-experiment --batch
+# Chaque ligne est une liste ; toutes les combinaisons sont simulées
+ues = 100, 500, 1000:10000:1000
+modes = RAP, EDT, PUR
+packets_per_day = 1, 24, 96
+battery_wh = 5, 10
+seeds = 1:10
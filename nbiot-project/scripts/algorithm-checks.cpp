@@ -0,0 +1,336 @@
+/*
+ * Known-answer checks for the simulator's numerical building blocks
+ *
+ * - Threefry-2x64-20 against the Random123 known-answer vectors
+ * - RunningStats and QuantileSketch: merging chunks in any order gives the
+ *   statistics of a single pass
+ * - Sobol indices of the Ishigami function against their exact values
+ * - BCa coverage of the mean of an exponential distribution
+ * - OccupancyBitmap and PurPlanner::assign against a plain std::set / vector
+ *   model, including sizes that are not a multiple of 64 and the wrap-around
+ *   to slot 0
+ * - InterferenceGrid after moveDevice/setSlot against a grid built from
+ *   scratch and a brute-force O(N²) sum
+ *
+ * Built and run by check_algorithms.sh; exits with 1 if any check fails.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include "bootstrap.h"
+#include "interference-grid.h"
+#include "pur-planner.h"
+#include "random-streams.h"
+#include "sensitivity-analysis.h"
+#include "streaming-stats.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* name, double value, double expected) {
+    std::printf("%-4s %-44s %.6g (expected %.6g)\n", ok ? "ok" : "FAIL", name, value, expected);
+    if (!ok) failures++;
+}
+
+// Uniforme reproductible dans ]0, 1[ : tirage `index` du flux `stream`
+static double uniform(uint64_t stream, uint64_t index) {
+    return RandomStreams::uniformFromBits(
+        static_cast<uint32_t>(RandomStreams::mixSeed(stream, index) >> 32));
+}
+
+static void checkThreefry() {
+    struct Vector {
+        uint64_t key0, key1, counter0, counter1, out0, out1;
+    };
+    // Random123 kat_vectors, threefry2x64 à 20 tours
+    const Vector vectors[2] = {
+        {0, 0, 0, 0, 0xc2b6e3a8c2c69865ULL, 0x6f81ed42f350084dULL},
+        {0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL, 0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL,
+         0x263c7d30bb0f0af1ULL, 0x56be8361d3311526ULL},
+    };
+    for (const Vector& v : vectors) {
+        uint64_t out0, out1;
+        RandomStreams::threefry2x64(v.key0, v.key1, v.counter0, v.counter1, out0, out1);
+        bool ok = out0 == v.out0 && out1 == v.out1;
+        std::printf("%-4s threefry2x64(%016llx, %016llx) = %016llx %016llx\n", ok ? "ok" : "FAIL",
+                    static_cast<unsigned long long>(v.counter0), static_cast<unsigned long long>(v.counter1),
+                    static_cast<unsigned long long>(out0), static_cast<unsigned long long>(out1));
+        if (!ok) failures++;
+    }
+}
+
+static void checkMerge() {
+    // Loi log-normale, quelques valeurs nulles pour le seau des non-positifs
+    std::vector<double> values(100000);
+    for (size_t i = 0; i < values.size(); i++) {
+        double u1 = uniform(1, 2 * i), u2 = uniform(1, 2 * i + 1);
+        double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        values[i] = i % 97 == 0 ? 0.0 : std::exp(1.0 + 0.5 * z);
+    }
+    RunningStats whole;
+    QuantileSketch wholeSketch;
+    for (double x : values) {
+        whole.add(x);
+        wholeSketch.add(x);
+    }
+
+    // Trois morceaux de tailles inégales, fusionnés dans l'ordre inverse
+    const size_t cuts[4] = {0, 1234, 60000, values.size()};
+    RunningStats parts[3];
+    QuantileSketch sketches[3];
+    for (int p = 0; p < 3; p++) {
+        for (size_t i = cuts[p]; i < cuts[p + 1]; i++) parts[p].add(values[i]);
+        sketches[p].addAll(values.data() + cuts[p], static_cast<int>(cuts[p + 1] - cuts[p]));
+    }
+    RunningStats merged;
+    QuantileSketch mergedSketch;
+    for (int p = 2; p >= 0; p--) {
+        merged.merge(parts[p]);
+        mergedSketch.merge(sketches[p]);
+    }
+
+    check(merged.count() == whole.count(), "RunningStats merge: count", static_cast<double>(merged.count()),
+          static_cast<double>(whole.count()));
+    check(std::fabs(merged.mean() - whole.mean()) <= 1e-12 * whole.mean(), "RunningStats merge: mean",
+          merged.mean(), whole.mean());
+    check(std::fabs(merged.variance() - whole.variance()) <= 1e-9 * whole.variance(),
+          "RunningStats merge: variance", merged.variance(), whole.variance());
+    check(merged.min() == whole.min() && merged.max() == whole.max(), "RunningStats merge: min and max",
+          merged.max(), whole.max());
+    const double quantiles[5] = {0.0, 0.01, 0.5, 0.95, 0.999};
+    for (double q : quantiles) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "QuantileSketch merge: q%g", q);
+        check(mergedSketch.quantile(q) == wholeSketch.quantile(q), name, mergedSketch.quantile(q),
+              wholeSketch.quantile(q));
+    }
+
+    // Le sketch reste à 0,4 % du quantile exact
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    double exact = sorted[static_cast<size_t>(0.95 * (sorted.size() - 1))];
+    check(std::fabs(wholeSketch.quantile(0.95) - exact) <= 0.004 * exact, "QuantileSketch p95 vs exact",
+          wholeSketch.quantile(0.95), exact);
+}
+
+static void checkIshigami() {
+    // f(x) = sin x1 + a sin² x2 + b x3⁴ sin x1, x dans [-π, π]³, a = 7, b = 0,1
+    const double a = 7.0, b = 0.1, pi = 3.141592653589793;
+    SensitivityAnalysis::SaltelliDesign design(3, 8192, 42);
+    std::vector<double> outputs(design.evaluationCount());
+    double x[3];
+    for (size_t e = 0; e < outputs.size(); e++) {
+        design.point(e, x);
+        for (double& value : x) value = -pi + 2.0 * pi * value;
+        outputs[e] = std::sin(x[0]) + a * std::sin(x[1]) * std::sin(x[1])
+                   + b * std::pow(x[2], 4) * std::sin(x[0]);
+    }
+    SensitivityAnalysis::Indices indices = SensitivityAnalysis::estimate(outputs, design);
+
+    // Valeurs exactes
+    const double v1 = 0.5 * std::pow(1.0 + b * std::pow(pi, 4) / 5.0, 2);
+    const double v2 = a * a / 8.0;
+    const double v13 = b * b * std::pow(pi, 8) * (1.0 / 18.0 - 1.0 / 50.0);
+    const double variance = v1 + v2 + v13;
+    const double first[3] = {v1 / variance, v2 / variance, 0.0};
+    const double total[3] = {(v1 + v13) / variance, v2 / variance, v13 / variance};
+    for (int i = 0; i < 3; i++) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "Ishigami S%d", i + 1);
+        check(std::fabs(indices.firstOrder[i] - first[i]) < 0.02, name, indices.firstOrder[i], first[i]);
+        std::snprintf(name, sizeof(name), "Ishigami T%d", i + 1);
+        check(std::fabs(indices.totalEffect[i] - total[i]) < 0.02, name, indices.totalEffect[i], total[i]);
+    }
+}
+
+static void checkBca() {
+    // Moyenne de 50 tirages d'une exponentielle de moyenne 1 : loi
+    // asymétrique, l'intervalle à 95 % doit la couvrir 95 % du temps
+    const int kTrials = 400, kSize = 50, kReplicates = 1000;
+    int covered = 0;
+    for (int trial = 0; trial < kTrials; trial++) {
+        const uint64_t stream = RandomStreams::mixSeed(2, trial);
+        std::vector<double> sample(kSize);
+        double sum = 0.0;
+        for (int i = 0; i < kSize; i++) {
+            sample[i] = -std::log(uniform(stream, i));
+            sum += sample[i];
+        }
+        std::vector<double> jackknife(kSize);
+        for (int i = 0; i < kSize; i++) jackknife[i] = (sum - sample[i]) / (kSize - 1);
+        std::vector<double> replicates(kReplicates);
+        for (int r = 0; r < kReplicates; r++) {
+            const uint64_t draws = RandomStreams::mixSeed(~stream, r);
+            double total = 0.0;
+            for (int i = 0; i < kSize; i++) {
+                total += sample[(RandomStreams::mixSeed(draws, i) >> 32) * kSize >> 32];
+            }
+            replicates[r] = total / kSize;
+        }
+        Bootstrap::Interval interval = Bootstrap::bcaInterval(sum / kSize, replicates, jackknife);
+        if (interval.low <= 1.0 && 1.0 <= interval.high) covered++;
+    }
+    double coverage = static_cast<double>(covered) / kTrials;
+    check(coverage >= 0.90 && coverage <= 0.985, "BCa coverage, exponential mean (n=50)", coverage, 0.95);
+}
+
+// Entier reproductible dans [0, n[
+static uint64_t below(uint64_t stream, uint64_t index, uint64_t n) {
+    return (RandomStreams::mixSeed(stream, index) >> 32) * n >> 32;
+}
+
+static void checkOccupancyBitmap() {
+    // 1, 63, 65 : un seul mot, partiel ; 4097 et 262145 : deux et quatre
+    // niveaux, le dernier mot de chaque niveau partiel
+    const uint64_t sizes[7] = {1, 63, 64, 65, 4097, 64 * 64 * 3 + 5, 262145};
+    for (uint64_t size : sizes) {
+        OccupancyBitmap bitmap(size);
+        std::set<uint64_t> free;
+        for (uint64_t i = 0; i < size; i++) free.insert(i);
+        const uint64_t stream = RandomStreams::mixSeed(3, size);
+        const uint64_t operations = std::max<uint64_t>(20000, 3 * size);
+        uint64_t mismatches = 0;
+        for (uint64_t op = 0; op < operations; op++) {
+            // Remplissage sur les deux premiers tiers, puis autant de
+            // libérations que d'occupations : des mots pleins apparaissent
+            // et se vident à tous les niveaux
+            const uint64_t index = below(stream, 3 * op, size);
+            const bool filling = op < 2 * operations / 3 || below(stream, 3 * op + 1, 2) == 0;
+            if (filling) {
+                bitmap.set(index);
+                free.erase(index);
+            } else {
+                bitmap.clear(index);
+                free.insert(index);
+            }
+            const uint64_t from = below(stream, 3 * op + 2, size + 2);
+            auto expected = free.lower_bound(from);
+            if (bitmap.findFree(from) != (expected == free.end() ? size : *expected)) mismatches++;
+        }
+        for (uint64_t i = 0; i < size; i++) bitmap.set(i);
+        if (bitmap.findFree(0) != size) mismatches++;
+        bitmap.clear(size - 1);
+        if (bitmap.findFree(0) != size - 1) mismatches++;
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "OccupancyBitmap vs std::set, %llu bits",
+                      static_cast<unsigned long long>(size));
+        check(mismatches == 0, name, static_cast<double>(mismatches), 0.0);
+    }
+}
+
+static void checkPurPlanner() {
+    // 7 × 3 = 21 ressources et 50 × 13 = 650 : des UE en trop pour que la
+    // cellule se remplisse et que les recherches repartent du créneau 0
+    const uint32_t grids[2][2] = {{7, 3}, {50, 13}};
+    for (const auto& grid : grids) {
+        const uint32_t slots = grid[0], tones = grid[1], ues = slots * tones + slots * tones / 4;
+        PurPlanner planner(slots, tones, ues);
+        std::vector<bool> occupied(slots * tones, false);
+        std::vector<uint32_t> resourceOf(ues, PurPlanner::kNone);
+        const uint64_t stream = RandomStreams::mixSeed(4, slots);
+        uint64_t mismatches = 0, wrapped = 0;
+        for (uint64_t op = 0; op < 50000; op++) {
+            const uint32_t ue = static_cast<uint32_t>(below(stream, 2 * op, ues));
+            if (resourceOf[ue] != PurPlanner::kNone) occupied[resourceOf[ue]] = false;
+            resourceOf[ue] = PurPlanner::kNone;
+            if (op % 5 == 4) {
+                planner.release(ue);
+            } else {
+                const uint32_t desired = static_cast<uint32_t>(below(stream, 2 * op + 1, 3 * slots));
+                const uint32_t start = desired % slots * tones;
+                for (uint32_t k = 0; k < occupied.size(); k++) {
+                    const uint32_t resource = (start + k) % occupied.size();
+                    if (!occupied[resource]) {
+                        resourceOf[ue] = resource;
+                        occupied[resource] = true;
+                        if (resource < start) wrapped++;
+                        break;
+                    }
+                }
+                if (planner.assign(ue, desired) != resourceOf[ue]) mismatches++;
+            }
+            uint64_t used = 0;
+            for (bool taken : occupied) used += taken;
+            if (planner.assigned() != used) mismatches++;
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "PurPlanner vs model, %u x %u", slots, tones);
+        check(mismatches == 0 && wrapped > 0, name, static_cast<double>(mismatches), 0.0);
+    }
+}
+
+static void checkInterferenceGrid() {
+    // Zone de 1 x 0,73 : la dernière rangée de cases est partielle ; quelques
+    // positions débordent de la zone et sont ramenées au bord
+    const double width = 1.0, height = 0.73, range = 0.1;
+    const int slots = 4, devices = 2000;
+    const uint64_t stream = 5;
+    std::vector<double> x(devices), y(devices);
+    std::vector<int> slot(devices);
+    InterferenceGrid grid(width, height, range, slots);
+    for (int i = 0; i < devices; i++) {
+        x[i] = uniform(stream, 3 * i) * width;
+        y[i] = uniform(stream, 3 * i + 1) * height;
+        slot[i] = static_cast<int>(below(stream, 3 * i + 2, slots));
+        grid.addDevice(x[i], y[i], slot[i]);
+    }
+
+    // Petits déplacements (souvent dans la même case), sauts, changements de
+    // créneau
+    const uint64_t moves = RandomStreams::mixSeed(stream, 1);
+    for (uint64_t op = 0; op < 20000; op++) {
+        const uint32_t id = static_cast<uint32_t>(below(moves, 4 * op, devices));
+        const double u = uniform(moves, 4 * op + 1), v = uniform(moves, 4 * op + 2);
+        switch (below(moves, 4 * op + 3, 3)) {
+        case 0:
+            x[id] += 0.3 * range * (u - 0.5);
+            y[id] += 0.3 * range * (v - 0.5);
+            grid.moveDevice(id, x[id], y[id]);
+            break;
+        case 1:
+            x[id] = -0.05 + 1.1 * width * u;
+            y[id] = -0.05 + 1.1 * height * v;
+            grid.moveDevice(id, x[id], y[id]);
+            break;
+        default:
+            slot[id] = static_cast<int>(u * slots);
+            grid.setSlot(id, slot[id]);
+            break;
+        }
+    }
+
+    InterferenceGrid rebuilt(width, height, range, slots);
+    for (int i = 0; i < devices; i++) rebuilt.addDevice(x[i], y[i], slot[i]);
+    double worstRebuilt = 0.0, worstBrute = 0.0, total = 0.0;
+    for (int i = 0; i < devices; i++) {
+        double brute = 0.0;
+        for (int j = 0; j < devices; j++) {
+            const double d2 = (x[j] - x[i]) * (x[j] - x[i]) + (y[j] - y[i]) * (y[j] - y[i]);
+            if (j != i && slot[j] == slot[i] && d2 < range * range) brute += 2.0 * (1.0 - d2 / (range * range));
+        }
+        const double load = grid.interferenceAt(i);
+        worstRebuilt = std::max(worstRebuilt, std::fabs(load - rebuilt.interferenceAt(i)));
+        worstBrute = std::max(worstBrute, std::fabs(load - brute));
+        total += load;
+    }
+    check(worstRebuilt <= 1e-9, "InterferenceGrid updates vs rebuilt grid", worstRebuilt, 0.0);
+    check(worstBrute <= 1e-9 && total > 0.0, "InterferenceGrid updates vs brute force", worstBrute, 0.0);
+}
+
+int main() {
+    checkThreefry();
+    checkMerge();
+    checkIshigami();
+    checkBca();
+    checkOccupancyBitmap();
+    checkPurPlanner();
+    checkInterferenceGrid();
+    std::printf("%s\n", failures == 0 ? "All checks passed" : "Some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
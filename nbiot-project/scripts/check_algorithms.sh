@@ -0,0 +1,18 @@
+#!/bin/bash
+# Vérifie les briques numériques du simulateur (algorithm-checks.cpp)
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+echo "========================================"
+echo "ALGORITHM CHECKS"
+echo "========================================"
+
+if ! g++ -std=c++17 -O2 -Wall -I "$SCRIPT_DIR/../src" -o "$WORK_DIR/algorithm_checks" \
+        "$SCRIPT_DIR/algorithm-checks.cpp" -lm; then
+    echo "✗ Compilation failed!"
+    exit 1
+fi
+
+"$WORK_DIR/algorithm_checks"
@@ -0,0 +1,74 @@
+#!/bin/bash
+# Vérifie qu'un balayage réparti sur N shards puis fusionné donne les mêmes
+# fichiers qu'une exécution en un seul processus
+#
+# Usage: ./check_shard_merge.sh [N] [simulator options...]
+# Par défaut : 3 shards, --seed 11 --devices 100,500,2000 --repeats 10, assez
+# d'unités par cellule pour que le bootstrap produise ses intervalles
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+SHARDS="${1:-3}"
+[ $# -gt 0 ] && shift
+OPTIONS=("$@")
+if [ ${#OPTIONS[@]} -eq 0 ]; then
+    OPTIONS=(--seed 11 --devices 100,500,2000 --repeats 10)
+fi
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+echo "========================================"
+echo "SHARD/MERGE CHECK ($SHARDS shards: ${OPTIONS[*]})"
+echo "========================================"
+
+if ! g++ -std=c++17 -O2 -pthread -o "$WORK_DIR/nbiot_simulator" "$SCRIPT_DIR/../src/simulation-script.cpp" -lm; then
+    echo "✗ Compilation failed!"
+    exit 1
+fi
+SIMULATOR="$WORK_DIR/nbiot_simulator"
+
+# Exécution de référence, en un seul processus
+"$SIMULATOR" "${OPTIONS[@]}" --output-dir "$WORK_DIR/single" > "$WORK_DIR/single.log" 2>&1 || {
+    echo "✗ Single-process run failed (see below)"
+    cat "$WORK_DIR/single.log"
+    exit 1
+}
+
+# Les shards tournent en parallèle, comme sur plusieurs machines
+pids=()
+for ((i = 0; i < SHARDS; i++)); do
+    "$SIMULATOR" "${OPTIONS[@]}" --shard "$i/$SHARDS" --output-dir "$WORK_DIR/shards" \
+        > "$WORK_DIR/shard$i.log" 2>&1 &
+    pids+=($!)
+done
+for ((i = 0; i < SHARDS; i++)); do
+    if ! wait "${pids[$i]}"; then
+        echo "✗ Shard $i/$SHARDS failed"
+        cat "$WORK_DIR/shard$i.log"
+        exit 1
+    fi
+done
+
+"$SIMULATOR" "${OPTIONS[@]}" --output-dir "$WORK_DIR/merged" --merge "$WORK_DIR"/shards/*.nbshard \
+    > "$WORK_DIR/merged.log" 2>&1 || {
+    echo "✗ Merge failed"
+    cat "$WORK_DIR/merged.log"
+    exit 1
+}
+
+status=0
+for file in real_simulation_results.csv detailed_results.txt bootstrap_intervals.csv; do
+    if [ ! -f "$WORK_DIR/single/$file" ] && [ ! -f "$WORK_DIR/merged/$file" ]; then
+        echo "-  $file (not produced by either run)"
+    elif cmp -s "$WORK_DIR/single/$file" "$WORK_DIR/merged/$file"; then
+        echo "✓ $file identical"
+    else
+        echo "✗ $file differs"
+        diff "$WORK_DIR/single/$file" "$WORK_DIR/merged/$file" | head -20
+        status=1
+    fi
+done
+
+if [ $status -eq 0 ]; then
+    echo "Merged results match the single-process run"
+fi
+exit $status
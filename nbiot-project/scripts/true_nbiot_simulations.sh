@@ -12,7 +12,7 @@ cd "$RESULTS_DIR"
 
 # Compiler le simulateur réaliste
 echo "Compiling realistic simulator..."
-g++ -std=c++11 -O2 -o nbiot_simulator ../simple_nbiot_sim.cc -lm
+g++ -std=c++17 -O2 -pthread -o nbiot_simulator ../src/simulation-script.cpp -lm
 
 if [ $? -eq 0 ]; then
     echo "✓ Compilation successful!"
@@ -31,8 +31,11 @@ if [ $? -eq 0 ]; then
         if [ $run -gt 1 ]; then
             mv real_simulation_results.csv "run${run}_results.csv"
             mv detailed_results.txt "run${run}_detailed.txt"
-            mv real_nbiot_simulation_results.png "run${run}_graph.png"
+            mv real_nbiot_simulation_results.svg "run${run}_graph.svg"
+            mv real_nbiot_simulation_results.html "run${run}_graph.html"
             mv simulation_report.txt "run${run}_report.txt"
+            # Absent quand le bootstrap est sauté (moins de 10 unités par cellule)
+            [ -f bootstrap_intervals.csv ] && mv bootstrap_intervals.csv "run${run}_bootstrap.csv"
         fi
     done
     
@@ -0,0 +1,454 @@
+/*
+ * Discrete-event NB-IoT access engine
+ *
+ * Simulates every UE of a cell as a small state machine driven by timer
+ * events: periodic reports trigger a random access (RAP, EDT) or a
+ * transmission on a preconfigured uplink resource (PUR). Random access
+ * goes through shared NPRACH occasions where UEs pick one of the preambles;
+ * two UEs on the same preamble collide and only find out when contention
+ * resolution fails, after which they back off and retry. Energy is
+ * integrated from radio power over the time spent in each state, sleep
+ * since the previous report included; latency runs from report arrival to
+ * data delivery. A report that exhausts its attempts is abandoned: its
+ * energy is counted in the failure statistics and carried into the UE's
+ * next delivered report, so the energy per delivered packet includes what
+ * the failed attempts spent.
+ *
+ * Without a plan, a PUR UE transmits at the end of its arrival window and
+ * the resources are unlimited. With purPlan, PurPlanner (pur-planner.h)
+ * gives each UE the first free NPUSCH slot after that instant on the tones
+ * reserved for PUR, and UEs left without a resource fall back to EDT.
+ *
+ * Events come from an EventPool and are ordered by a TimingWheel
+ * (event-queue.h). Each UE draws from its own counter-based stream, so a
+ * run depends only on the seed.
+ */
+
+#ifndef NBIOT_ACCESS_ENGINE_H
+#define NBIOT_ACCESS_ENGINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "event-queue.h"
+#include "mode-policies.h"
+#include "pur-planner.h"
+#include "random-streams.h"
+#include "streaming-stats.h"
+
+// Paramètres du modèle d'accès (durées en ms, puissances en W)
+struct AccessConfig {
+    double simulatedDays = 1.0;
+    double reportingPeriodMs = 3600000.0;    // 24 paquets par jour
+    double arrivalJitterMs = 20.0;           // dispersion de l'instant du rapport
+
+    double nprachPeriodMs = 40.0;
+    int preambles = 48;                      // sous-porteuses NPRACH
+    int maxGrantsPerOccasion = 16;           // RAR par occasion
+    double preambleMs = 5.6;
+    double rarWindowMs = 10.0;
+    double msg3Ms = 8.0;
+    double edtMsg3Ms = 16.0;                 // Msg3 avec les données (EDT)
+    double msg4Ms = 10.0;
+    double contentionTimerMs = 64.0;
+    double backoffMs = 256.0;                // tirage uniforme dans [0, backoff]
+    int maxAttempts = 10;
+
+    double dataMs = 16.0;                    // données après connexion RRC (RAP)
+    double connectedTailMs = 10000.0;        // inactivité avant libération RRC
+    double purDataMs = 16.0;
+    double purAckMs = 10.0;
+    double purFallbackProbability = 0.05;    // TA invalide : repli sur EDT
+    bool purPlan = false;                    // ressources PUR attribuées par PurPlanner
+    int purTones = 6;                        // sous-porteuses single tone réservées aux PUR (sur 12)
+
+    double txPowerW = 0.7;
+    double rxPowerW = 0.2;
+    double connectedIdlePowerW = 0.05;
+    double sleepPowerW = 15e-6;              // PSM / eDRX entre deux rapports
+};
+
+// Plan PUR d'une cellule ; instants en µs depuis le début de la période
+struct PurPlan {
+    PurPlanner planner;
+    std::vector<int64_t> ready;          // fin de la fenêtre d'arrivée de chaque UE
+    std::vector<int64_t> offsets;        // instant de sa ressource (>= ready), -1 sans ressource
+};
+
+struct AccessResult {
+    RunningStats energy;                 // J par paquet livré, veille et rapports abandonnés compris
+    RunningStats latency;                // ms, arrivée du rapport → livraison
+    RunningStats failedEnergy;           // J dépensés par rapport abandonné
+    RunningStats failedLatency;          // ms, arrivée du rapport → abandon
+    QuantileSketch energySketch;
+    QuantileSketch latencySketch;
+    std::vector<double> energies;        // remplis avec keepSamples
+    std::vector<double> latencies;
+
+    uint64_t events = 0;
+    uint64_t deliveries = 0;
+    uint64_t failures = 0;               // tentatives épuisées
+    uint64_t preambles = 0;              // préambules émis
+    uint64_t collisions = 0;             // préambules partagés avec un autre UE
+};
+
+class AccessEngine {
+public:
+    AccessEngine(const AccessConfig& config, AccessProcedure procedure,
+                 uint64_t seed, int numDevices, bool keepSamples = false, bool antithetic = false)
+        : config(config), procedure(procedure), seed(seed), keepSamples(keepSamples),
+          flip(antithetic ? (1ULL << 53) - 1 : 0),
+          ues(numDevices), preambleUsers(config.preambles, 0),
+          preambleGrant(config.preambles, 0) {
+        horizon = toMicros(config.simulatedDays * 86400000.0);
+        period = toMicros(config.reportingPeriodMs);
+        jitter = toMicros(config.arrivalJitterMs);
+        nprachPeriod = toMicros(config.nprachPeriodMs);
+        preambleTime = toMicros(config.preambleMs);
+        rarWindow = toMicros(config.rarWindowMs);
+        msg3Time = toMicros(config.msg3Ms);
+        edtMsg3Time = toMicros(config.edtMsg3Ms);
+        msg4Time = toMicros(config.msg4Ms);
+        contentionTimer = toMicros(config.contentionTimerMs);
+        dataTime = toMicros(config.dataMs);
+        connectedTail = toMicros(config.connectedTailMs);
+        purDataTime = toMicros(config.purDataMs);
+        purAckTime = toMicros(config.purAckMs);
+    }
+
+    // Chaque UE demande le premier créneau PUR qui suit sa fenêtre
+    // d'arrivée ; même phase que dans run() (premier tirage de son flux)
+    static PurPlan planPur(const AccessConfig& config, uint64_t seed, int numDevices, bool antithetic) {
+        const int64_t period = toMicros(config.reportingPeriodMs);
+        const int64_t jitter = toMicros(config.arrivalJitterMs);
+        const int64_t slot = toMicros(config.purDataMs);
+        const uint64_t flip = antithetic ? (1ULL << 53) - 1 : 0;
+        PurPlan plan{PurPlanner(static_cast<uint32_t>(period / slot), static_cast<uint32_t>(config.purTones),
+                                static_cast<uint32_t>(numDevices)),
+                     std::vector<int64_t>(numDevices), std::vector<int64_t>(numDevices, -1)};
+        for (int id = 0; id < numDevices; id++) {
+            int64_t phase = static_cast<int64_t>(uniformAt(seed, static_cast<uint32_t>(id), 0, flip) * period);
+            int64_t ready = phase + jitter;
+            plan.ready[id] = ready;
+            uint32_t desired = static_cast<uint32_t>((ready + slot - 1) / slot);
+            if (plan.planner.assign(static_cast<uint32_t>(id), desired) == PurPlanner::kNone) continue;
+            int64_t offset = static_cast<int64_t>(plan.planner.slotOf(static_cast<uint32_t>(id))) * slot;
+            while (offset < ready) offset += period;
+            plan.offsets[id] = offset;
+        }
+        return plan;
+    }
+
+    AccessResult run() {
+        for (uint32_t id = 0; id < ues.size(); id++) {
+            Ue& ue = ues[id];
+            ue.draws = 0;
+            ue.report = 0;
+            ue.chargedUntil = 0;
+            ue.carriedEnergy = 0.0;
+            ue.phase = static_cast<int64_t>(uniform(ue, id) * period);
+            scheduleReport(id, 0);
+        }
+        if (procedure == AccessProcedure::Preconfigured && config.purPlan) {
+            purOffsets = planPur(config, seed, static_cast<int>(ues.size()), flip != 0).offsets;
+        }
+
+        while (Event* event = queue.pop()) {
+            int64_t now = event->time;
+            uint64_t target = event->target;
+            uint8_t kind = event->kind;
+            events.release(event);
+            result.events++;
+
+            if (kind == kNprachOccasion) {
+                handleOccasion(target, now);
+            } else {
+                handleTimer(static_cast<uint32_t>(target), now);
+            }
+        }
+        return std::move(result);
+    }
+
+private:
+    enum EventKind : uint8_t { kUeTimer, kNprachOccasion };
+
+    enum class UeState : uint8_t {
+        Sleeping,                        // en attente du prochain rapport
+        WaitingForOccasion,
+        AwaitingRar,
+        AwaitingContentionResolution,
+        TransmittingData,
+        ConnectedTail,
+        BackingOff,
+        WaitingForPur,
+        AwaitingPurAck
+    };
+
+    enum class RachOutcome : uint8_t { NoGrant, Collided, Granted };
+
+    struct Ue {
+        int64_t phase;                   // décalage du trafic périodique
+        int64_t arrival;                 // arrivée du rapport en cours
+        int64_t delivered;
+        int64_t chargedUntil;            // énergie comptée jusqu'à cet instant
+        double energy;
+        double carriedEnergy;            // énergie des rapports abandonnés depuis la dernière livraison
+        uint64_t draws;                  // compteur du flux aléatoire
+        uint32_t report;
+        uint16_t attempts;
+        UeState state;
+        RachOutcome outcome;
+        bool earlyData;                  // données dans Msg3 (EDT ou repli PUR)
+    };
+
+    static int64_t toMicros(double ms) { return static_cast<int64_t>(std::llround(ms * 1000.0)); }
+
+    static double uniformAt(uint64_t seed, uint32_t id, uint64_t counter, uint64_t flip) {
+        uint64_t out0, out1;
+        RandomStreams::threefry2x64(seed, RandomStreams::kAccessDomain, id, counter, out0, out1);
+        return (((out0 >> 11) ^ flip) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+    double uniform(Ue& ue, uint32_t id) { return uniformAt(seed, id, ue.draws++, flip); }
+
+    void schedule(int64_t time, uint64_t target, uint8_t kind) {
+        Event* event = events.allocate();
+        event->time = time;
+        event->target = target;
+        event->kind = kind;
+        queue.push(event);
+    }
+
+    void setTimer(uint32_t id, UeState state, int64_t time) {
+        ues[id].state = state;
+        schedule(time, id, kUeTimer);
+    }
+
+    // Énergie consommée depuis le dernier passage, à puissance constante
+    void charge(Ue& ue, int64_t now, double powerW) {
+        ue.energy += powerW * (now - ue.chargedUntil) * 1e-6;
+        ue.chargedUntil = now;
+    }
+
+    void transmit(Ue& ue, int64_t now, int64_t duration) {
+        ue.energy += config.txPowerW * duration * 1e-6;
+        ue.chargedUntil = now + duration;
+    }
+
+    void scheduleReport(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        int64_t base = ue.phase + static_cast<int64_t>(ue.report) * period;
+        if (base >= horizon) {
+            ue.state = UeState::Sleeping;
+            return;
+        }
+        int64_t arrival = base + static_cast<int64_t>(uniform(ue, id) * jitter);
+        setTimer(id, UeState::Sleeping, std::max(now, arrival));
+    }
+
+    void startReport(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        ue.arrival = now;
+        ue.energy = ue.carriedEnergy;
+        ue.carriedEnergy = 0.0;
+        charge(ue, now, config.sleepPowerW);
+        ue.attempts = 0;
+        ue.earlyData = procedure != AccessProcedure::RandomAccess;
+
+        if (procedure == AccessProcedure::Preconfigured &&
+            uniform(ue, id) >= config.purFallbackProbability) {
+            // Ressource PUR du plan, ou à la fin de la fenêtre d'arrivée sans plan
+            int64_t offset = purOffsets.empty() ? ue.phase + jitter : purOffsets[id];
+            if (offset >= 0) {
+                int64_t occasion = static_cast<int64_t>(ue.report) * period + offset;
+                setTimer(id, UeState::WaitingForPur, std::max(now, occasion));
+                return;
+            }
+        }
+        requestAccess(id, now);
+    }
+
+    // Inscription à la prochaine occasion NPRACH (strictement après now)
+    void requestAccess(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        ue.attempts++;
+        ue.state = UeState::WaitingForOccasion;
+        charge(ue, now, config.sleepPowerW);
+
+        uint64_t occasion = static_cast<uint64_t>(now / nprachPeriod) + 1;
+        std::vector<uint32_t>& registrants = pendingOccasion[occasion & 1];
+        if (registrants.empty()) {
+            schedule(static_cast<int64_t>(occasion) * nprachPeriod, occasion, kNprachOccasion);
+        }
+        registrants.push_back(id);
+    }
+
+    void handleOccasion(uint64_t occasion, int64_t now) {
+        std::vector<uint32_t>& registrants = pendingOccasion[occasion & 1];
+
+        chosenPreamble.resize(registrants.size());
+        for (size_t i = 0; i < registrants.size(); i++) {
+            Ue& ue = ues[registrants[i]];
+            uint16_t preamble = static_cast<uint16_t>(uniform(ue, registrants[i]) * config.preambles);
+            chosenPreamble[i] = preamble;
+            preambleUsers[preamble]++;
+        }
+
+        // La station de base répond à chaque préambule détecté, dans la limite des RAR
+        int grants = 0;
+        for (size_t i = 0; i < registrants.size(); i++) {
+            uint32_t id = registrants[i];
+            Ue& ue = ues[id];
+            uint16_t preamble = chosenPreamble[i];
+            if (preambleGrant[preamble] == 0) {
+                preambleGrant[preamble] = grants < config.maxGrantsPerOccasion ? 1 : 2;
+                if (preambleGrant[preamble] == 1) grants++;
+            }
+
+            bool shared = preambleUsers[preamble] > 1;
+            if (shared) result.collisions++;
+            result.preambles++;
+
+            if (preambleGrant[preamble] == 2) {
+                ue.outcome = RachOutcome::NoGrant;
+            } else {
+                ue.outcome = shared ? RachOutcome::Collided : RachOutcome::Granted;
+            }
+
+            charge(ue, now, config.sleepPowerW);
+            transmit(ue, now, preambleTime);
+            setTimer(id, UeState::AwaitingRar, now + preambleTime + rarWindow);
+        }
+
+        for (uint16_t preamble : chosenPreamble) {
+            preambleUsers[preamble] = 0;
+            preambleGrant[preamble] = 0;
+        }
+        registrants.clear();
+    }
+
+    void handleTimer(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        switch (ue.state) {
+        case UeState::Sleeping:
+            startReport(id, now);
+            break;
+
+        case UeState::WaitingForOccasion:
+            break;
+
+        case UeState::AwaitingRar: {
+            charge(ue, now, config.rxPowerW);
+            if (ue.outcome == RachOutcome::NoGrant) {
+                retryOrGiveUp(id, now);
+                break;
+            }
+            int64_t msg3 = ue.earlyData ? edtMsg3Time : msg3Time;
+            int64_t wait = ue.outcome == RachOutcome::Collided ? contentionTimer : msg4Time;
+            transmit(ue, now, msg3);
+            setTimer(id, UeState::AwaitingContentionResolution, now + msg3 + wait);
+            break;
+        }
+
+        case UeState::AwaitingContentionResolution:
+            charge(ue, now, config.rxPowerW);
+            if (ue.outcome == RachOutcome::Collided) {
+                retryOrGiveUp(id, now);
+            } else if (ue.earlyData) {
+                ue.delivered = now;
+                finishReport(id, now);
+            } else {
+                transmit(ue, now, dataTime);
+                setTimer(id, UeState::TransmittingData, now + dataTime);
+            }
+            break;
+
+        case UeState::TransmittingData:
+            ue.delivered = now;
+            setTimer(id, UeState::ConnectedTail, now + connectedTail);
+            break;
+
+        case UeState::ConnectedTail:
+            charge(ue, now, config.connectedIdlePowerW);
+            finishReport(id, now);
+            break;
+
+        case UeState::BackingOff:
+            requestAccess(id, now);
+            break;
+
+        case UeState::WaitingForPur:
+            charge(ue, now, config.sleepPowerW);
+            transmit(ue, now, purDataTime);
+            setTimer(id, UeState::AwaitingPurAck, now + purDataTime + purAckTime);
+            break;
+
+        case UeState::AwaitingPurAck:
+            charge(ue, now, config.rxPowerW);
+            ue.delivered = now;
+            finishReport(id, now);
+            break;
+        }
+    }
+
+    void retryOrGiveUp(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        if (ue.attempts >= config.maxAttempts) {
+            // L'énergie dépensée reste due : elle passe au rapport suivant
+            result.failures++;
+            result.failedEnergy.add(ue.energy);
+            result.failedLatency.add((now - ue.arrival) * 1e-3);
+            ue.carriedEnergy = ue.energy;
+            ue.report++;
+            scheduleReport(id, now);
+            return;
+        }
+        int64_t backoff = static_cast<int64_t>(uniform(ue, id) * config.backoffMs * 1000.0);
+        setTimer(id, UeState::BackingOff, now + backoff);
+    }
+
+    void finishReport(uint32_t id, int64_t now) {
+        Ue& ue = ues[id];
+        double latencyMs = (ue.delivered - ue.arrival) * 1e-3;
+        result.energy.add(ue.energy);
+        result.latency.add(latencyMs);
+        result.energySketch.add(ue.energy);
+        result.latencySketch.add(latencyMs);
+        if (keepSamples) {
+            result.energies.push_back(ue.energy);
+            result.latencies.push_back(latencyMs);
+        }
+        result.deliveries++;
+
+        ue.report++;
+        scheduleReport(id, now);
+    }
+
+    AccessConfig config;
+    AccessProcedure procedure;
+    uint64_t seed;
+    bool keepSamples;
+    uint64_t flip;                       // 2^53 - 1 en mode antithétique : u -> 1 - u
+
+    int64_t horizon, period, jitter, nprachPeriod;
+    int64_t preambleTime, rarWindow, msg3Time, edtMsg3Time, msg4Time, contentionTimer;
+    int64_t dataTime, connectedTail, purDataTime, purAckTime;
+
+    std::vector<Ue> ues;
+    std::vector<int64_t> purOffsets;     // PurPlan::offsets avec purPlan, vide sinon
+    EventPool events;
+    TimingWheel queue;
+
+    // Une seule occasion NPRACH est ouverte aux inscriptions à la fois,
+    // deux listes suffisent (l'occasion en cours et la suivante)
+    std::vector<uint32_t> pendingOccasion[2];
+    std::vector<uint16_t> chosenPreamble;
+    std::vector<uint16_t> preambleUsers;
+    std::vector<uint8_t> preambleGrant;    // 0 : non vu, 1 : RAR envoyé, 2 : pas de RAR
+
+    AccessResult result;
+};
+
+#endif // NBIOT_ACCESS_ENGINE_H
@@ -0,0 +1,451 @@
+/*
+ * Cluster bootstrap with BCa confidence intervals
+ *
+ * The replications of a cell are the independent units, not its devices:
+ * each replication draws its own base energy and latency, so most of the
+ * spread of a cell mean comes from the replication it ran in. A bootstrap
+ * replicate therefore draws the units (replications, or antithetic pairs)
+ * with replacement, then the devices of every drawn replication.
+ *
+ * Devices are not drawn one by one. Each replication keeps its per-device
+ * values in a QuantileSketch, and drawing its n devices with replacement only
+ * changes the bucket counts. The new counts are independent Poisson draws
+ * with the original counts as means (Poisson bootstrap), so a replicate costs
+ * one draw per occupied bucket, whatever the number of devices. Every draw
+ * comes from a counter-based hash of (seed, replicate, bucket): replicates
+ * can run on any thread in any order. Means are corrected by the exact mean
+ * of each replication, so the binning only affects quantiles, within the
+ * resolution of the sketch.
+ *
+ * Resampling the units alone already carries the device-level spread, through
+ * the unit means; the device draws mostly smooth the quantiles of small
+ * samples. Past kDeviceResamplingMaxUnits units they are dropped, and a
+ * replicate only weights the precomputed totals of each unit by the number of
+ * times it was drawn.
+ *
+ * Intervals are bias-corrected and accelerated (BCa, Efron 1987). The bias
+ * correction comes from the share of replicates below the estimate, the
+ * acceleration from a leave-one-unit-out jackknife, obtained by subtracting
+ * each unit from the totals.
+ */
+
+#ifndef NBIOT_BOOTSTRAP_H
+#define NBIOT_BOOTSTRAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "random-streams.h"
+#include "streaming-stats.h"
+
+namespace Bootstrap {
+
+inline double normalCdf(double x) {
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+// Quantile de la loi normale : approximation rationnelle d'Acklam, puis une
+// itération de Halley
+inline double normalQuantile(double p) {
+    static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00};
+    if (p <= 0.0) return -std::numeric_limits<double>::infinity();
+    if (p >= 1.0) return std::numeric_limits<double>::infinity();
+
+    double x;
+    if (p < 0.02425 || p > 1.0 - 0.02425) {
+        double q = std::sqrt(-2.0 * std::log(std::min(p, 1.0 - p)));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+          / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        if (p > 0.5) x = -x;
+    } else {
+        double q = p - 0.5, r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+          / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+    double e = normalCdf(x) - p;
+    double u = e * std::sqrt(2.0 * M_PI) * std::exp(0.5 * x * x);
+    return x - u / (1.0 + 0.5 * x * u);
+}
+
+struct Interval {
+    double estimate;
+    double low;     // NaN sans assez d'unités
+    double high;
+
+    bool valid() const { return std::isfinite(low) && std::isfinite(high); }
+};
+
+// Quantile p d'un échantillon trié, interpolé entre rangs
+inline double sortedQuantile(const std::vector<double>& sorted, double p) {
+    double position = std::min(1.0, std::max(0.0, p)) * (sorted.size() - 1);
+    size_t below = static_cast<size_t>(position);
+    if (below + 1 >= sorted.size()) return sorted.back();
+    return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+// Intervalle BCa de niveau `level` ; `replicates` est trié sur place
+inline Interval bcaInterval(double estimate, std::vector<double>& replicates,
+                            const std::vector<double>& jackknife, double level = 0.95) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    Interval interval{estimate, nan, nan};
+    if (replicates.size() < 2 || jackknife.size() < 2) return interval;
+    std::sort(replicates.begin(), replicates.end());
+
+    // Correction de biais : part des réplicats sous l'estimation, les ex aequo
+    // (fréquents pour un quantile d'histogramme) comptant pour moitié
+    const double count = static_cast<double>(replicates.size());
+    auto ties = std::equal_range(replicates.begin(), replicates.end(), estimate);
+    double below = (ties.first - replicates.begin()) + 0.5 * (ties.second - ties.first);
+    double z0 = normalQuantile(std::min(std::max(below / count, 0.5 / count), 1.0 - 0.5 / count));
+
+    // Accélération : asymétrie des valeurs du jackknife
+    double jackMean = 0.0;
+    for (double value : jackknife) jackMean += value;
+    jackMean /= jackknife.size();
+    double cubes = 0.0, squares = 0.0;
+    for (double value : jackknife) {
+        double deviation = jackMean - value;
+        squares += deviation * deviation;
+        cubes += deviation * deviation * deviation;
+    }
+    double acceleration = squares > 0.0 ? cubes / (6.0 * std::pow(squares, 1.5)) : 0.0;
+
+    auto adjusted = [&](double z) {
+        double shifted = z0 + z;
+        double denominator = 1.0 - acceleration * shifted;
+        if (denominator <= 0.0) return shifted > 0.0 ? 1.0 : 0.0;
+        return normalCdf(z0 + shifted / denominator);
+    };
+    double z = normalQuantile(0.5 + 0.5 * level);
+    interval.low = sortedQuantile(replicates, adjusted(-z));
+    interval.high = sortedQuantile(replicates, adjusted(z));
+    return interval;
+}
+
+// Loi normale par inversion d'un uniforme : table de la fonction quantile,
+// interpolée, et calcul direct dans les queues
+inline double normalFromUniform(double u) {
+    static const int kTableSize = 4096;
+    static const std::vector<double> table = [] {
+        std::vector<double> values(kTableSize + 1);
+        for (int i = 1; i < kTableSize; i++) values[i] = normalQuantile(static_cast<double>(i) / kTableSize);
+        return values;
+    }();
+    double position = u * kTableSize;
+    if (position < 1.0 || position >= kTableSize - 1) return normalQuantile(u);
+    int below = static_cast<int>(position);
+    return table[below] + (position - below) * (table[below + 1] - table[below]);
+}
+
+// Tirage de Poisson de moyenne `lambda` (un effectif de seau, donc entier)
+// à partir de 64 bits aléatoires : inversion d'une fonction de répartition
+// précalculée pour les petites moyennes, approximation normale corrigée de
+// l'asymétrie au-delà
+inline double poissonFromBits(double lambda, uint64_t bits) {
+    static const int kInversionLimit = 16;
+    static const int kMaxDraw = 64;
+    static const std::vector<double> cumulative = [] {
+        std::vector<double> values(kInversionLimit * kMaxDraw, 1.0);
+        for (int mean = 1; mean < kInversionLimit; mean++) {
+            double probability = std::exp(-static_cast<double>(mean)), sum = probability;
+            for (int k = 0; k < kMaxDraw - 1; k++) {
+                values[mean * kMaxDraw + k] = sum;
+                probability *= static_cast<double>(mean) / (k + 1);
+                sum += probability;
+            }
+        }
+        return values;
+    }();
+    double u = RandomStreams::uniformFromBits(static_cast<uint32_t>(bits));
+    if (lambda < kInversionLimit) {
+        const double* table = &cumulative[static_cast<int>(lambda) * kMaxDraw];
+        int k = 0;
+        while (u > table[k]) k++;
+        return k;
+    }
+    double z = normalFromUniform(u);
+    return std::max(0.0, std::floor(lambda + std::sqrt(lambda) * z + (z * z - 1.0) / 6.0 + 0.5));
+}
+
+// Une réplication d'une série : valeurs par appareil et leur moyenne exacte
+struct Sample {
+    const QuantileSketch* sketch;
+    double mean;
+};
+
+class ClusterBootstrap {
+public:
+    // Unités au-delà desquelles les appareils ne sont plus rééchantillonnés
+    static constexpr size_t kDeviceResamplingMaxUnits = 100;
+
+    // Moyenne et quantile de chaque série, poolés sur les unités retenues,
+    // et moyenne de chaque unité retenue (unitMean[s][j], dans l'ordre du tirage)
+    struct Statistics {
+        std::vector<double> mean;
+        std::vector<double> quantile;
+        std::vector<std::vector<double>> unitMean;
+    };
+
+    // series[s][r] : réplication r de la série s ; units[u] : réplications
+    // formant l'unité u (les mêmes pour toutes les séries, ce qui apparie
+    // les séries entre elles)
+    ClusterBootstrap(const std::vector<std::vector<Sample>>& series, const std::vector<std::vector<int>>& units,
+                     double q)
+        : units(units), q(q), maxUnitSize(0) {
+        for (const auto& unit : units) {
+            maxUnitSize = std::max(maxUnitSize, unit.size());
+            for (int r : unit) {
+                for (const auto& replications : series) {
+                    if (r < 0 || static_cast<size_t>(r) >= replications.size()) {
+                        throw std::invalid_argument("Bootstrap unit refers to a missing replication");
+                    }
+                }
+            }
+        }
+        for (const auto& replications : series) {
+            data.push_back(buildSeries(replications));
+            accumulateUnits(data.back());
+        }
+    }
+
+    size_t seriesCount() const { return data.size(); }
+    size_t unitCount() const { return units.size(); }
+    bool resamplesDevices() const { return units.size() <= kDeviceResamplingMaxUnits; }
+
+    // Estimation sur toutes les unités
+    Statistics estimate() const {
+        Statistics statistics;
+        for (const Series& series : data) {
+            statistics.mean.push_back(series.total > 0.0 ? series.sum / series.total : 0.0);
+            statistics.quantile.push_back(quantileOf(series.counts, series.total, series.values));
+            statistics.unitMean.push_back(series.unitMean);
+        }
+        return statistics;
+    }
+
+    // Estimation sans l'unité `leftOut` (jackknife) : ses effectifs et sa
+    // somme sont retirés des totaux
+    Statistics leaveOneOut(size_t leftOut) const {
+        Statistics statistics;
+        std::vector<double> counts;
+        for (const Series& series : data) {
+            counts = series.counts;
+            for (int r : units[leftOut]) {
+                const Histogram& histogram = series.replications[r];
+                for (size_t k = 0; k < histogram.lambda.size(); k++) {
+                    counts[histogram.buckets[k]] -= histogram.lambda[k];
+                }
+            }
+            const double total = series.total - series.unitTotal[leftOut];
+            const double sum = series.sum - series.unitSum[leftOut];
+            statistics.mean.push_back(total > 0.0 ? sum / total : 0.0);
+            statistics.quantile.push_back(quantileOf(counts, total, series.values));
+            std::vector<double> unitMean(series.unitMean.begin(), series.unitMean.begin() + leftOut);
+            unitMean.insert(unitMean.end(), series.unitMean.begin() + leftOut + 1, series.unitMean.end());
+            statistics.unitMean.push_back(std::move(unitMean));
+        }
+        return statistics;
+    }
+
+    // Réplicat `index` : ne dépend que de (seed, index)
+    Statistics replicate(uint64_t seed, uint64_t index) const {
+        uint64_t key = RandomStreams::mixSeed(seed, index);
+        std::vector<int> drawn(units.size());
+        for (size_t j = 0; j < units.size(); j++) {
+            uint64_t bits = RandomStreams::mixSeed(key, ~static_cast<uint64_t>(j));
+            drawn[j] = static_cast<int>(((bits >> 32) * units.size()) >> 32);
+        }
+        return resamplesDevices() ? pooled(drawn, key) : weighted(drawn);
+    }
+
+private:
+    // Seaux occupés d'une réplication : position dans la grille de la série
+    // et effectif
+    struct Histogram {
+        std::vector<uint32_t> buckets;
+        std::vector<double> lambda;
+        double meanCorrection;    // moyenne exacte - moyenne des milieux de seau
+    };
+
+    // Grille commune aux réplications : valeurs nulles ou négatives en
+    // position 0, puis les seaux des sketches
+    struct Series {
+        std::vector<double> values;
+        std::vector<Histogram> replications;
+        // Totaux sur toutes les unités, et effectif, somme et moyenne de
+        // chaque unité
+        std::vector<double> counts;
+        double total;
+        double sum;
+        std::vector<double> unitTotal;
+        std::vector<double> unitSum;
+        std::vector<double> unitMean;
+    };
+
+    static Series buildSeries(const std::vector<Sample>& replications) {
+        Series series;
+        int64_t first = std::numeric_limits<int64_t>::max(), last = std::numeric_limits<int64_t>::min();
+        for (const Sample& sample : replications) {
+            const std::vector<uint64_t>& counts = sample.sketch->bucketCounts();
+            if (counts.empty()) continue;
+            first = std::min(first, sample.sketch->firstBucketIndex());
+            last = std::max(last, sample.sketch->firstBucketIndex() + static_cast<int64_t>(counts.size()));
+        }
+        if (first > last) first = last = 0;
+        series.values.push_back(0.0);
+        for (int64_t bucket = first; bucket < last; bucket++) {
+            series.values.push_back(QuantileSketch::bucketMidpoint(bucket));
+        }
+
+        for (const Sample& sample : replications) {
+            Histogram histogram;
+            if (sample.sketch->nonPositiveCount() > 0) {
+                histogram.buckets.push_back(0);
+                histogram.lambda.push_back(static_cast<double>(sample.sketch->nonPositiveCount()));
+            }
+            const std::vector<uint64_t>& counts = sample.sketch->bucketCounts();
+            const int64_t offset = 1 + sample.sketch->firstBucketIndex() - first;
+            for (size_t k = 0; k < counts.size(); k++) {
+                if (counts[k] == 0) continue;
+                histogram.buckets.push_back(static_cast<uint32_t>(offset + static_cast<int64_t>(k)));
+                histogram.lambda.push_back(static_cast<double>(counts[k]));
+            }
+
+            double total = 0.0, binnedSum = 0.0;
+            for (size_t k = 0; k < histogram.lambda.size(); k++) {
+                total += histogram.lambda[k];
+                binnedSum += histogram.lambda[k] * series.values[histogram.buckets[k]];
+            }
+            histogram.meanCorrection = total > 0.0 ? sample.mean - binnedSum / total : 0.0;
+            series.replications.push_back(std::move(histogram));
+        }
+        return series;
+    }
+
+    // Totaux de la série, dans l'ordre d'accumulation de pooled()
+    void accumulateUnits(Series& series) const {
+        series.counts.assign(series.values.size(), 0.0);
+        series.total = series.sum = 0.0;
+        for (const std::vector<int>& unit : units) {
+            double unitTotal = 0.0, unitSum = 0.0;
+            for (int r : unit) {
+                const Histogram& histogram = series.replications[r];
+                double n = 0.0, binnedSum = 0.0;
+                for (size_t k = 0; k < histogram.lambda.size(); k++) {
+                    series.counts[histogram.buckets[k]] += histogram.lambda[k];
+                    n += histogram.lambda[k];
+                    binnedSum += histogram.lambda[k] * series.values[histogram.buckets[k]];
+                }
+                unitTotal += n;
+                unitSum += binnedSum + histogram.meanCorrection * n;
+            }
+            series.unitTotal.push_back(unitTotal);
+            series.unitSum.push_back(unitSum);
+            series.unitMean.push_back(unitTotal > 0.0 ? unitSum / unitTotal : 0.0);
+            series.total += unitTotal;
+            series.sum += unitSum;
+        }
+    }
+
+    // Statistiques des unités `drawn` sans tirer les appareils : chaque unité
+    // compte autant de fois qu'elle a été tirée
+    Statistics weighted(const std::vector<int>& drawn) const {
+        std::vector<double> times(units.size(), 0.0);
+        for (int u : drawn) times[u] += 1.0;
+        Statistics statistics;
+        std::vector<double> counts;
+        for (const Series& series : data) {
+            counts.assign(series.values.size(), 0.0);
+            double total = 0.0, sum = 0.0;
+            for (size_t u = 0; u < units.size(); u++) {
+                if (times[u] == 0.0) continue;
+                for (int r : units[u]) {
+                    const Histogram& histogram = series.replications[r];
+                    for (size_t k = 0; k < histogram.lambda.size(); k++) {
+                        counts[histogram.buckets[k]] += times[u] * histogram.lambda[k];
+                    }
+                }
+                total += times[u] * series.unitTotal[u];
+                sum += times[u] * series.unitSum[u];
+            }
+            statistics.mean.push_back(total > 0.0 ? sum / total : 0.0);
+            statistics.quantile.push_back(quantileOf(counts, total, series.values));
+            std::vector<double> unitMean(drawn.size());
+            for (size_t j = 0; j < drawn.size(); j++) unitMean[j] = series.unitMean[drawn[j]];
+            statistics.unitMean.push_back(std::move(unitMean));
+        }
+        return statistics;
+    }
+
+    // Statistiques des unités `drawn`, les appareils de chaque réplication
+    // tirée étant rééchantillonnés avec la clé `key`
+    Statistics pooled(const std::vector<int>& drawn, uint64_t key) const {
+        Statistics statistics;
+        std::vector<double> counts;
+        for (size_t s = 0; s < data.size(); s++) {
+            const Series& series = data[s];
+            counts.assign(series.values.size(), 0.0);
+            double total = 0.0, sum = 0.0;
+            std::vector<double> unitMean(drawn.size());
+            for (size_t j = 0; j < drawn.size(); j++) {
+                const std::vector<int>& unit = units[drawn[j]];
+                double unitTotal = 0.0, unitSum = 0.0;
+                for (size_t position = 0; position < unit.size(); position++) {
+                    const Histogram& histogram = series.replications[unit[position]];
+                    const uint32_t* buckets = histogram.buckets.data();
+                    const double* lambda = histogram.lambda.data();
+                    const size_t size = histogram.lambda.size();
+                    double n = 0.0, binnedSum = 0.0;
+                    uint64_t stream = RandomStreams::mixSeed(key, (j * maxUnitSize + position) * data.size() + s);
+                    for (size_t k = 0; k < size; k++) {
+                        double drawnCount = poissonFromBits(lambda[k], RandomStreams::splitMix64(stream + k));
+                        counts[buckets[k]] += drawnCount;
+                        n += drawnCount;
+                        binnedSum += drawnCount * series.values[buckets[k]];
+                    }
+                    unitTotal += n;
+                    unitSum += binnedSum + histogram.meanCorrection * n;
+                }
+                unitMean[j] = unitTotal > 0.0 ? unitSum / unitTotal : 0.0;
+                total += unitTotal;
+                sum += unitSum;
+            }
+            statistics.mean.push_back(total > 0.0 ? sum / total : 0.0);
+            statistics.quantile.push_back(quantileOf(counts, total, series.values));
+            statistics.unitMean.push_back(std::move(unitMean));
+        }
+        return statistics;
+    }
+
+    // Même rang que QuantileSketch::quantile
+    double quantileOf(const std::vector<double>& counts, double total, const std::vector<double>& values) const {
+        if (total <= 0.0) return 0.0;
+        double rank = std::floor(q * (total - 1.0));
+        double seen = 0.0;
+        for (size_t k = 0; k < counts.size(); k++) {
+            seen += counts[k];
+            if (seen > rank) return values[k];
+        }
+        return values.back();
+    }
+
+    std::vector<std::vector<int>> units;
+    double q;
+    size_t maxUnitSize;
+    std::vector<Series> data;
+};
+
+} // namespace Bootstrap
+
+#endif // NBIOT_BOOTSTRAP_H
@@ -0,0 +1,184 @@
+/*
+ * Link budget and coverage-enhancement lookup tables
+ *
+ * With --coverage ce, the device's distance to the site sets its uplink
+ * SINR, and the SINR sets its coverage-enhancement level (CE0/1/2), MCS and
+ * repetition count, hence the airtime and energy of its access procedure:
+ *
+ *   path loss  120.9 + 37.6·log10(d km) + 20 dB indoor penetration
+ *              (TR 36.888 macro at 900 MHz; distance 1 of the grid = 3 km)
+ *   SINR       23 dBm - path loss - (-174 dBm/Hz + 15 kHz + NF 5 dB)
+ *   CE level   CE0 from 0 dB, CE1 from -10 dB, CE2 below
+ *   NPUSCH     single tone, 8 ms resource units; the (MCS, repetitions)
+ *              pair with the shortest airtime whose SINR + 10·log10(R)
+ *              reaches the MCS threshold, R at most 2 / 16 / 128 per CE
+ *   NPRACH     1 / 8 / 32 preamble repetitions of 5.6 ms
+ *   downlink   1 / 8 / 64 repetitions of 2 ms per message
+ *   power      543 mW transmitting, 90 mW receiving (TR 45.820)
+ *
+ * A mode's base energy and latency are those of a device at the site. The
+ * tables hold the extra energy (J) and airtime (ms) of every other position.
+ * They are computed at compile time. Each table is indexed by squared
+ * normalised distance and chains path loss, SINR, CE level, MCS and
+ * repetitions for its procedure. The kernel reads the nearest entry with a
+ * vector gather, so no square root or logarithm remains per device. The
+ * cost is a step function of SINR, because MCS and repetitions are
+ * discrete. Interpolating between entries would blend two configurations
+ * that no device uses. With 1025 entries the grid resolves distance to
+ * about 0.2% at the cell edge.
+ */
+
+#ifndef NBIOT_COVERAGE_TABLES_H
+#define NBIOT_COVERAGE_TABLES_H
+
+#include <algorithm>
+
+#include "mode-policies.h"
+
+namespace Coverage {
+
+constexpr double kTxPowerDbm = 23.0;
+constexpr double kNoiseDbm = -174.0 + 41.7609 + 5.0;     // 10·log10(15 kHz) = 41,76
+constexpr double kPenetrationLossDb = 20.0;
+constexpr double kGridSpanKm = 3.0;                       // distance normalisée 1 (côté de la grille)
+constexpr double kMinDistanceKm = 0.035;
+
+constexpr double kCe1BelowDb = 0.0;                       // SINR sous lequel on passe en CE1
+constexpr double kCe2BelowDb = -10.0;
+
+constexpr double kTxPowerW = 0.543;
+constexpr double kRxPowerW = 0.090;
+constexpr double kResourceUnitMs = 8.0;
+constexpr double kPreambleMs = 5.6;
+constexpr double kDownlinkMs = 2.0;
+
+// Par niveau CE : répétitions maximales NPUSCH, NPRACH et descendantes
+constexpr int kMaxUplinkRepetitions[3] = {2, 16, 128};
+constexpr int kPreambleRepetitions[3] = {1, 8, 32};
+constexpr int kDownlinkRepetitions[3] = {1, 8, 64};
+
+// NPUSCH single tone : TBS sur 1 RU (TS 36.213 tab. 16.5.1.2-2) et SINR requis (approché)
+struct Mcs {
+    int tbsBits;
+    double requiredSinrDb;
+};
+constexpr Mcs kMcs[11] = {{16, -5.5}, {32, -3.5}, {56, -1.5}, {88, 0.5}, {120, 2.0}, {152, 3.5},
+                          {208, 5.5}, {256, 7.0}, {296, 8.5}, {344, 10.0}, {392, 11.5}};
+
+// Messages de chaque procédure : bits montants, messages descendants, préambule
+struct Procedure {
+    int uplinkBits[2];
+    int downlinkMessages;
+    bool preamble;
+};
+constexpr Procedure kProcedures[3] = {
+    {{88, 256}, 3, true},     // RandomAccess : Msg3, données ; Msg2, Msg4, libération
+    {{344, 0}, 2, true},      // EarlyData : données dans Msg3 ; Msg2, Msg4
+    {{256, 0}, 1, false}};    // Preconfigured : données sur PUR ; acquittement
+
+constexpr int kSquaredDistanceEntries = 1025;
+constexpr double kMaxSquaredDistance = 4.0;               // au-delà : coût du bord de la table
+
+// Surcoûts par procédure et carré de la distance normalisée
+struct Tables {
+    double extraEnergyJ[3][kSquaredDistanceEntries];
+    double extraLatencyMs[3][kSquaredDistanceEntries];
+};
+
+// ln(x), x > 0, évaluable à la compilation : réduction par puissances de 2
+// puis série atanh (|t| < 0,172, 20 termes)
+constexpr double constexprLog(double x) {
+    int exponent = 0;
+    while (x > 1.4142135623730951) { x *= 0.5; exponent++; }
+    while (x < 0.7071067811865476) { x *= 2.0; exponent--; }
+    double t = (x - 1.0) / (x + 1.0);
+    double t2 = t * t;
+    double sum = 0.0;
+    double power = t;
+    for (int k = 1; k < 40; k += 2) {
+        sum += power / k;
+        power *= t2;
+    }
+    return exponent * 0.6931471805599453 + 2.0 * sum;
+}
+
+constexpr double constexprLog10(double x) { return constexprLog(x) / 2.302585092994046; }
+
+constexpr int ceLevel(double sinrDb) {
+    return sinrDb >= kCe1BelowDb ? 0 : (sinrDb >= kCe2BelowDb ? 1 : 2);
+}
+
+// Durée d'émission NPUSCH d'un message, au meilleur couple (MCS, répétitions)
+constexpr double uplinkMs(int bits, double sinrDb, int level) {
+    double best = 0.0;
+    for (int mcs = 0; mcs < 11; mcs++) {
+        for (int repetitions = 1; repetitions <= kMaxUplinkRepetitions[level]; repetitions *= 2) {
+            if (sinrDb + 10.0 * constexprLog10(repetitions) < kMcs[mcs].requiredSinrDb) continue;
+            int units = (bits + kMcs[mcs].tbsBits - 1) / kMcs[mcs].tbsBits;
+            double airtime = units * kResourceUnitMs * repetitions;
+            if (best == 0.0 || airtime < best) best = airtime;
+        }
+    }
+    // Hors couverture : effort maximal, MCS 0 et toutes les répétitions
+    if (best == 0.0) {
+        best = (bits + kMcs[0].tbsBits - 1) / kMcs[0].tbsBits * kResourceUnitMs * kMaxUplinkRepetitions[level];
+    }
+    return best;
+}
+
+struct ProcedureCost {
+    double energyJ;
+    double airtimeMs;
+};
+
+constexpr ProcedureCost procedureCost(const Procedure& procedure, double sinrDb) {
+    int level = ceLevel(sinrDb);
+    double txMs = 0.0;
+    for (int bits : procedure.uplinkBits) {
+        if (bits > 0) txMs += uplinkMs(bits, sinrDb, level);
+    }
+    if (procedure.preamble) txMs += kPreambleRepetitions[level] * kPreambleMs;
+    double rxMs = procedure.downlinkMessages * kDownlinkRepetitions[level] * kDownlinkMs;
+    return {(txMs * kTxPowerW + rxMs * kRxPowerW) / 1000.0, txMs + rxMs};
+}
+
+// SINR d'un appareil au carré de distance normalisée `squared`
+constexpr double sinrDb(double squared) {
+    double minimum = (kMinDistanceKm / kGridSpanKm) * (kMinDistanceKm / kGridSpanKm);
+    double squaredKm = std::max(squared, minimum) * kGridSpanKm * kGridSpanKm;
+    // 37,6·log10(d) = 18,8·log10(d²)
+    double pathLoss = 120.9 + 18.8 * constexprLog10(squaredKm) + kPenetrationLossDb;
+    return kTxPowerDbm - pathLoss - kNoiseDbm;
+}
+
+constexpr Tables buildTables() {
+    Tables tables{};
+    for (int p = 0; p < 3; p++) {
+        ProcedureCost reference = procedureCost(kProcedures[p], sinrDb(0.0));
+        for (int i = 0; i < kSquaredDistanceEntries; i++) {
+            double squared = kMaxSquaredDistance * i / (kSquaredDistanceEntries - 1);
+            ProcedureCost cost = procedureCost(kProcedures[p], sinrDb(squared));
+            tables.extraEnergyJ[p][i] = cost.energyJ - reference.energyJ;
+            tables.extraLatencyMs[p][i] = cost.airtimeMs - reference.airtimeMs;
+        }
+    }
+    return tables;
+}
+
+inline constexpr Tables kTables = buildTables();
+
+static_assert(sinrDb(0.0) > sinrDb(kMaxSquaredDistance), "SINR must fall with distance");
+static_assert(ceLevel(sinrDb(0.0)) == 0 && ceLevel(sinrDb(kMaxSquaredDistance)) == 2,
+              "the grid must span CE0 to CE2");
+static_assert(kTables.extraEnergyJ[2][kSquaredDistanceEntries - 1] < kTables.extraEnergyJ[0][kSquaredDistanceEntries - 1],
+              "without a preamble, PUR costs less than RAP in deep coverage");
+
+// Position dans les tables d'un appareil en (x, y) sur une grille de n
+// appareils : (x² + y²) · coverageScale(n)
+inline double coverageScale(int numDevices) {
+    return (kSquaredDistanceEntries - 1) / (kMaxSquaredDistance * numDevices);
+}
+
+} // namespace Coverage
+
+#endif // NBIOT_COVERAGE_TABLES_H
@@ -0,0 +1,365 @@
+/*
+ * Vectorised device kernel body
+ *
+ * Included several times by device-kernel.h, once per instruction set, with
+ * NBIOT_KERNEL_NAMESPACE and NBIOT_KERNEL_ISA set. The algorithm below is
+ * written once against a handful of lane operations; only those operations
+ * change between the scalar, AVX2 and AVX-512 builds, so every build performs
+ * the same arithmetic in the same order and returns bit-identical values.
+ */
+
+// Pas de garde d'inclusion : ce fichier est inclus une fois par jeu d'instructions
+
+namespace NBIOT_KERNEL_NAMESPACE {
+
+#if NBIOT_KERNEL_ISA == NBIOT_ISA_AVX512
+
+typedef __m512d VD;
+typedef __m512i VU;
+typedef __mmask8 VM;
+const int kLanes = 8;
+
+inline VD setD(double x) { return _mm512_set1_pd(x); }
+inline VU setU(uint64_t x) { return _mm512_set1_epi64(static_cast<long long>(x)); }
+inline VU counterU(uint64_t first) {
+    return _mm512_add_epi64(setU(first), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+}
+inline VD loadD(const double* p) { return _mm512_load_pd(p); }
+inline void storeD(double* p, VD x) { _mm512_store_pd(p, x); }
+inline VD addD(VD a, VD b) { return _mm512_add_pd(a, b); }
+inline VD subD(VD a, VD b) { return _mm512_sub_pd(a, b); }
+inline VD mulD(VD a, VD b) { return _mm512_mul_pd(a, b); }
+inline VD divD(VD a, VD b) { return _mm512_div_pd(a, b); }
+inline VD sqrtD(VD a) { return _mm512_maskz_sqrt_pd(0xFF, a); }  // évite un faux avertissement de GCC 12
+inline VM greaterD(VD a, VD b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+inline VD selectD(VM mask, VD ifTrue, VD ifFalse) { return _mm512_mask_blend_pd(mask, ifFalse, ifTrue); }
+inline VD gatherD(const double* table, VU index) {
+    return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, index, table, 8);   // idem
+}
+inline VU addU(VU a, VU b) { return _mm512_add_epi64(a, b); }
+inline VU xorU(VU a, VU b) { return _mm512_xor_si512(a, b); }
+inline VU andU(VU a, VU b) { return _mm512_and_si512(a, b); }
+inline VU orU(VU a, VU b) { return _mm512_or_si512(a, b); }
+// Décalages en extensions vectorielles GCC (les intrinsèques de GCC 12
+// déclenchent un faux -Wmaybe-uninitialized) ; compilés en vprolq / vpsrlq
+typedef unsigned long long U64x8 __attribute__((vector_size(64)));
+template <int R> inline VU rotlU(VU x) {
+    U64x8 v = (U64x8)x;
+    return (VU)((v << R) | (v >> (64 - R)));
+}
+template <int R> inline VU shrU(VU x) { return (VU)((U64x8)x >> R); }
+inline VD asD(VU x) { return _mm512_castsi512_pd(x); }
+inline VU asU(VD x) { return _mm512_castpd_si512(x); }
+
+#elif NBIOT_KERNEL_ISA == NBIOT_ISA_AVX2
+
+typedef __m256d VD;
+typedef __m256i VU;
+typedef __m256d VM;
+const int kLanes = 4;
+
+inline VD setD(double x) { return _mm256_set1_pd(x); }
+inline VU setU(uint64_t x) { return _mm256_set1_epi64x(static_cast<long long>(x)); }
+inline VU counterU(uint64_t first) {
+    return _mm256_add_epi64(setU(first), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+inline VD loadD(const double* p) { return _mm256_load_pd(p); }
+inline void storeD(double* p, VD x) { _mm256_store_pd(p, x); }
+inline VD addD(VD a, VD b) { return _mm256_add_pd(a, b); }
+inline VD subD(VD a, VD b) { return _mm256_sub_pd(a, b); }
+inline VD mulD(VD a, VD b) { return _mm256_mul_pd(a, b); }
+inline VD divD(VD a, VD b) { return _mm256_div_pd(a, b); }
+inline VD sqrtD(VD a) { return _mm256_sqrt_pd(a); }
+inline VM greaterD(VD a, VD b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+inline VD selectD(VM mask, VD ifTrue, VD ifFalse) { return _mm256_blendv_pd(ifFalse, ifTrue, mask); }
+inline VD gatherD(const double* table, VU index) { return _mm256_i64gather_pd(table, index, 8); }
+inline VU addU(VU a, VU b) { return _mm256_add_epi64(a, b); }
+inline VU xorU(VU a, VU b) { return _mm256_xor_si256(a, b); }
+inline VU andU(VU a, VU b) { return _mm256_and_si256(a, b); }
+inline VU orU(VU a, VU b) { return _mm256_or_si256(a, b); }
+template <int R> inline VU rotlU(VU x) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64 - R));
+}
+template <int R> inline VU shrU(VU x) { return _mm256_srli_epi64(x, R); }
+inline VD asD(VU x) { return _mm256_castsi256_pd(x); }
+inline VU asU(VD x) { return _mm256_castpd_si256(x); }
+
+#else
+
+typedef double VD;
+typedef uint64_t VU;
+typedef bool VM;
+const int kLanes = 1;
+
+inline VD setD(double x) { return x; }
+inline VU setU(uint64_t x) { return x; }
+inline VU counterU(uint64_t first) { return first; }
+inline VD loadD(const double* p) { return *p; }
+inline void storeD(double* p, VD x) { *p = x; }
+inline VD addD(VD a, VD b) { return a + b; }
+inline VD subD(VD a, VD b) { return a - b; }
+inline VD mulD(VD a, VD b) { return a * b; }
+inline VD divD(VD a, VD b) { return a / b; }
+inline VD sqrtD(VD a) { return std::sqrt(a); }
+inline VM greaterD(VD a, VD b) { return a > b; }
+inline VD selectD(VM mask, VD ifTrue, VD ifFalse) { return mask ? ifTrue : ifFalse; }
+inline VD gatherD(const double* table, VU index) { return table[index]; }
+inline VU addU(VU a, VU b) { return a + b; }
+inline VU xorU(VU a, VU b) { return a ^ b; }
+inline VU andU(VU a, VU b) { return a & b; }
+inline VU orU(VU a, VU b) { return a | b; }
+template <int R> inline VU rotlU(VU x) { return (x << R) | (x >> (64 - R)); }
+template <int R> inline VU shrU(VU x) { return x >> R; }
+inline VD asD(VU x) { double d; std::memcpy(&d, &x, sizeof(d)); return d; }
+inline VU asU(VD x) { uint64_t u; std::memcpy(&u, &x, sizeof(u)); return u; }
+
+#endif
+
+template <int R>
+inline void threefryRound(VU& x0, VU& x1) {
+    x0 = addU(x0, x1);
+    x1 = xorU(rotlU<R>(x1), x0);
+}
+
+template <uint64_t S>
+inline void threefryInject(VU& x0, VU& x1, const uint64_t* ks) {
+    x0 = addU(x0, setU(ks[S % 3]));
+    x1 = addU(x1, setU(ks[(S + 1) % 3] + S));
+}
+
+template <uint64_t S>
+inline void threefryFourRounds(VU& x0, VU& x1, const uint64_t* ks) {
+    if (S % 2 == 1) {
+        threefryRound<16>(x0, x1); threefryRound<42>(x0, x1);
+        threefryRound<12>(x0, x1); threefryRound<31>(x0, x1);
+    } else {
+        threefryRound<16>(x0, x1); threefryRound<32>(x0, x1);
+        threefryRound<24>(x0, x1); threefryRound<21>(x0, x1);
+    }
+    threefryInject<S>(x0, x1, ks);
+}
+
+// Threefry-2x64-20 sur plusieurs compteurs ; identique à RandomStreams::threefry2x64
+inline void threefry(const uint64_t* ks, VU counter0, VU& x0, VU& x1) {
+    // Second mot du compteur toujours nul
+    x0 = addU(counter0, setU(ks[0]));
+    x1 = setU(ks[1]);
+    threefryFourRounds<1>(x0, x1, ks);
+    threefryFourRounds<2>(x0, x1, ks);
+    threefryFourRounds<3>(x0, x1, ks);
+    threefryFourRounds<4>(x0, x1, ks);
+    threefryFourRounds<5>(x0, x1, ks);
+}
+
+// 32 bits aléatoires -> uniforme dans ]0, 1[ (conversion exacte par 2^52)
+inline VD uniform(VU bits32) {
+    VD exact = subD(asD(orU(bits32, setU(0x4330000000000000ULL))), setD(4503599627370496.0));
+    return mulD(addD(exact, setD(0.5)), setD(1.0 / 4294967296.0));
+}
+
+// ln(u) pour u dans ]0, 1[ : exposant + série atanh sur la mantisse
+inline VD logUnit(VD u) {
+    VU bits = asU(u);
+    VD exponent = subD(subD(asD(orU(shrU<52>(bits), setU(0x4330000000000000ULL))),
+                            setD(4503599627370496.0)), setD(1023.0));
+    VD mantissa = asD(orU(andU(bits, setU(0x000FFFFFFFFFFFFFULL)), setU(0x3FF0000000000000ULL)));
+
+    VM high = greaterD(mantissa, setD(1.4142135623730951));
+    mantissa = selectD(high, mulD(mantissa, setD(0.5)), mantissa);
+    exponent = selectD(high, addD(exponent, setD(1.0)), exponent);
+
+    VD t = divD(subD(mantissa, setD(1.0)), addD(mantissa, setD(1.0)));
+    VD t2 = mulD(t, t);
+    VD p = setD(1.0 / 19.0);
+    p = addD(mulD(p, t2), setD(1.0 / 17.0));
+    p = addD(mulD(p, t2), setD(1.0 / 15.0));
+    p = addD(mulD(p, t2), setD(1.0 / 13.0));
+    p = addD(mulD(p, t2), setD(1.0 / 11.0));
+    p = addD(mulD(p, t2), setD(1.0 / 9.0));
+    p = addD(mulD(p, t2), setD(1.0 / 7.0));
+    p = addD(mulD(p, t2), setD(1.0 / 5.0));
+    p = addD(mulD(p, t2), setD(1.0 / 3.0));
+    p = addD(mulD(p, t2), setD(1.0));
+    VD logMantissa = mulD(mulD(setD(2.0), t), p);
+    return addD(mulD(exponent, setD(0.6931471805599453)), logMantissa);
+}
+
+// cos(2*pi*v) pour v dans ]0, 1[ : réduction au premier quart de période
+inline VD cosTurn(VD v) {
+    VD w = asD(andU(asU(subD(v, setD(0.5))), setU(0x7FFFFFFFFFFFFFFFULL)));
+    VM upper = greaterD(w, setD(0.25));
+    VD b = selectD(upper, subD(setD(0.5), w), w);
+    VD sign = selectD(upper, setD(1.0), setD(-1.0));
+
+    VD x = mulD(b, setD(6.283185307179586));
+    VD x2 = mulD(x, x);
+    VD c = setD(1.0 / 2432902008176640000.0);
+    c = subD(mulD(c, x2), setD(1.0 / 6402373705728000.0));
+    c = addD(mulD(c, x2), setD(1.0 / 20922789888000.0));
+    c = subD(mulD(c, x2), setD(1.0 / 87178291200.0));
+    c = addD(mulD(c, x2), setD(1.0 / 479001600.0));
+    c = subD(mulD(c, x2), setD(1.0 / 3628800.0));
+    c = addD(mulD(c, x2), setD(1.0 / 40320.0));
+    c = subD(mulD(c, x2), setD(1.0 / 720.0));
+    c = addD(mulD(c, x2), setD(1.0 / 24.0));
+    c = subD(mulD(c, x2), setD(0.5));
+    c = addD(mulD(c, x2), setD(1.0));
+    return mulD(sign, c);
+}
+
+// Facteurs intermédiaires du modèle d'appareil, un par voie
+struct Factors {
+    VD uVariation, uInterference, uRadius, uAngle;
+    VD variation;
+    VD energyBase, latencyBase;     // valeurs de base, surcoût CE compris
+    VD distanceEffect;              // 1 avec --coverage ce
+    VD interferenceLoad;            // charge des voisins, ou N/1000 · (0,8 + 0,4·u)
+    VD interferenceEffect;
+    VD normal, noise;
+    VD energy, latency;
+};
+
+// Modèle d'un groupe de kLanes appareils consécutifs à partir de `first` ;
+// `neighbourLoad` n'est lu qu'avec l'interférence spatiale. Les constantes
+// du modèle viennent de `Constants` (ModeConstants ou CellConstants,
+// device-kernel.h). always_inline : hors ligne, les constantes ne sortent
+// plus de la boucle de simulateBlock
+template <class Mode, class Constants>
+__attribute__((always_inline)) inline Factors deviceFactors(const DeviceKernel::CellParams& cell,
+                                                            uint64_t first, VD gx, VD gy,
+                                                            VD neighbourLoad) {
+    const uint64_t ks[3] = {cell.seed, RandomStreams::kDeviceDomain,
+                            cell.seed ^ RandomStreams::kDeviceDomain ^ 0x1BD11BDAA9FC1A22ULL};
+    const VU low32 = setU(0xFFFFFFFFULL);
+    // Complément des 32 bits : uniform() renvoie alors exactement 1 - u
+    const VU flip = setU(cell.antithetic ? 0xFFFFFFFFULL : 0);
+    const int procedure = static_cast<int>(ModeTraits<Mode>::kProcedure);
+    Factors f;
+
+    VU r0, r1;
+    threefry(ks, counterU(first), r0, r1);
+
+    f.uVariation = uniform(xorU(andU(r0, low32), flip));
+    f.uInterference = uniform(xorU(shrU<32>(r0), flip));
+    f.uRadius = uniform(andU(r1, low32));
+    f.uAngle = uniform(shrU<32>(r1));
+
+    // Variation individuelle ±10 %
+    f.variation = addD(setD(Constants::variationLow(cell)), mulD(f.uVariation, setD(Constants::variationSpan(cell))));
+
+    // Effet distance : surcoût CE ajouté aux valeurs de base, ou
+    // pénalité linéaire en distance
+    f.energyBase = setD(cell.baseEnergy);
+    f.latencyBase = setD(cell.baseLatency);
+    VD common;
+    if (cell.coverageModel) {
+        const VD lastEntry = setD(Coverage::kSquaredDistanceEntries - 1);
+        VD position = mulD(addD(mulD(gx, gx), mulD(gy, gy)), setD(cell.coverageScale));
+        position = selectD(greaterD(position, lastEntry), lastEntry, position);
+        // Case la plus proche : arrondi par 1,5·2^52, l'entier est dans la mantisse
+        VU entry = andU(asU(addD(position, setD(6755399441055744.0))), setU(0x0007FFFFFFFFFFFFULL));
+        f.energyBase = addD(f.energyBase, gatherD(Coverage::kTables.extraEnergyJ[procedure], entry));
+        f.latencyBase = addD(f.latencyBase, gatherD(Coverage::kTables.extraLatencyMs[procedure], entry));
+        f.distanceEffect = setD(1.0);
+        common = f.variation;
+    } else {
+        VD distance = sqrtD(addD(mulD(gx, gx), mulD(gy, gy)));
+        f.distanceEffect = addD(setD(1.0), mulD(distance, setD(cell.distanceScale)));
+        common = mulD(f.variation, f.distanceEffect);
+    }
+
+    // Effet interférence : charge moyenne de la cellule, ou charge des
+    // voisins calculée par l'appelant
+    const VD interferenceCoeff = setD(Constants::interferenceCoeff(cell));
+    if (cell.spatialInterference) {
+        f.interferenceLoad = neighbourLoad;
+        f.interferenceEffect = addD(setD(1.0), mulD(interferenceCoeff, neighbourLoad));
+    } else {
+        const VD interferenceScale = setD(cell.interferenceLoad * Constants::interferenceCoeff(cell));
+        VD randomLoad = addD(setD(0.8), mulD(f.uInterference, setD(0.4)));
+        f.interferenceLoad = mulD(setD(cell.interferenceLoad), randomLoad);
+        f.interferenceEffect = addD(setD(1.0), mulD(interferenceScale, randomLoad));
+    }
+
+    // Bruit gaussien (Box-Muller)
+    VD radius = sqrtD(mulD(setD(-2.0), logUnit(f.uRadius)));
+    f.normal = mulD(mulD(radius, cosTurn(f.uAngle)), setD(cell.antithetic ? -1.0 : 1.0));
+    f.noise = addD(setD(0.95), mulD(f.normal, setD(Constants::noiseSigma(cell))));
+
+    f.energy = mulD(mulD(mulD(f.energyBase, common), f.interferenceEffect), f.noise);
+    f.latency = mulD(mulD(mulD(f.latencyBase, common), setD(cell.latencyScale)), f.noise);
+    return f;
+}
+
+// Instancié une fois par mode et par source de constantes : la procédure
+// (ligne des tables Coverage) est toujours fixée par le mode ; avec
+// ModeConstants, coefficient d'interférence, variation et bruit le sont aussi
+template <class Mode, class Constants>
+inline void simulateBlock(const DeviceKernel::CellParams& cell, int64_t firstDevice,
+                          DeviceKernel::Block& block) {
+    // Positions sur la grille : incréments entiers, sans division par appareil
+    int64_t x = firstDevice % cell.gridWidth;
+    int64_t y = firstDevice / cell.gridWidth;
+    for (int i = 0; i < DeviceKernel::kBlockSize; i++) {
+        block.gridX[i] = static_cast<double>(x);
+        block.gridY[i] = static_cast<double>(y);
+        if (++x == cell.gridWidth) {
+            x = 0;
+            y++;
+        }
+    }
+
+    for (int i = 0; i < DeviceKernel::kBlockSize; i += kLanes) {
+        Factors f = deviceFactors<Mode, Constants>(cell, static_cast<uint64_t>(firstDevice + i),
+                                        loadD(block.gridX + i), loadD(block.gridY + i),
+                                        cell.spatialInterference ? loadD(block.interference + i) : setD(0.0));
+        storeD(block.energy + i, f.energy);
+        storeD(block.latency + i, f.latency);
+    }
+}
+
+// Somme, moyenne et M2 d'un bloc : 8 accumulateurs (valeur i -> i % 8) quel
+// que soit le jeu d'instructions, pour que la réduction soit la même partout
+inline void summarizeBlock(const double* values, int count, DeviceKernel::BlockSummary& out) {
+    double partial[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    double low[8], high[8];
+    for (int k = 0; k < 8; k++) low[k] = high[k] = values[0];
+
+    int full = count & ~7;
+    for (int i = 0; i < full; i += 8) {
+        for (int k = 0; k < 8; k++) {
+            partial[k] += values[i + k];
+            low[k] = std::min(low[k], values[i + k]);
+            high[k] = std::max(high[k], values[i + k]);
+        }
+    }
+    for (int i = full; i < count; i++) {
+        partial[i & 7] += values[i];
+        low[i & 7] = std::min(low[i & 7], values[i]);
+        high[i & 7] = std::max(high[i & 7], values[i]);
+    }
+    double sum = ((partial[0] + partial[4]) + (partial[1] + partial[5]))
+               + ((partial[2] + partial[6]) + (partial[3] + partial[7]));
+    double mean = sum / count;
+
+    double squares[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < full; i += 8) {
+        for (int k = 0; k < 8; k++) {
+            double d = values[i + k] - mean;
+            squares[k] += d * d;
+        }
+    }
+    for (int i = full; i < count; i++) {
+        double d = values[i] - mean;
+        squares[i & 7] += d * d;
+    }
+
+    out.count = count;
+    out.mean = mean;
+    out.m2 = ((squares[0] + squares[4]) + (squares[1] + squares[5]))
+           + ((squares[2] + squares[6]) + (squares[3] + squares[7]));
+    out.min = *std::min_element(low, low + 8);
+    out.max = *std::max_element(high, high + 8);
+}
+
+} // namespace NBIOT_KERNEL_NAMESPACE
@@ -0,0 +1,253 @@
+/*
+ * Structure-of-arrays device kernel with runtime instruction-set dispatch
+ *
+ * Devices are simulated in blocks of kBlockSize. For each block the kernel
+ * draws all random numbers in bulk from Threefry, applies Box-Muller with
+ * polynomial log/cos, and writes energies and latencies into flat arrays.
+ * The body in device-kernel-impl.h is compiled for plain scalar code, AVX2
+ * and AVX-512; the widest variant the CPU supports is picked at run time.
+ */
+
+#ifndef NBIOT_DEVICE_KERNEL_H
+#define NBIOT_DEVICE_KERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "coverage-tables.h"
+#include "mode-policies.h"
+#include "random-streams.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NBIOT_KERNEL_HAS_X86 1
+#include <immintrin.h>
+#else
+#define NBIOT_KERNEL_HAS_X86 0
+#endif
+
+namespace DeviceKernel {
+
+const int kBlockSize = 256;
+
+enum class Isa { Scalar, Avx2, Avx512 };
+
+// Tout ce qui ne change pas d'un appareil à l'autre, calculé une fois par cellule
+struct CellParams {
+    uint64_t seed;
+    int numDevices;
+    double baseEnergy;
+    double baseLatency;
+    int64_t gridWidth;           // (int)sqrt(numDevices), largeur de la grille
+    double distanceScale;        // 0.5 / sqrt(numDevices)
+    double interferenceLoad;     // numDevices / 1000
+    double interferenceCoeff;    // lus par CellConstants seulement (points de --sensitivity) ;
+    double variationLow;         // le balayage utilise les constantes de ModeConstants
+    double variationSpan;
+    double noiseSigma;
+    double latencyScale;         // 1 + numDevices / 10000
+    bool spatialInterference;    // charge lue dans Block::interference (InterferenceGrid)
+    bool coverageModel;          // surcoût CE des tables Coverage au lieu de l'effet distance linéaire
+    double coverageScale;        // x² + y² -> position dans les tables Coverage
+    bool antithetic;             // variable antithétique : u -> 1 - u, bruit gaussien opposé
+};
+
+// Constantes du modèle par défaut : variation individuelle dans
+// [0,9, 1,1[ et bruit 0,95 + 0,1·N(0, 1)
+const double kVariationLow = 0.9;
+const double kVariationSpan = 0.2;
+const double kNoiseSigma = 0.1;
+
+// Source des constantes lues par le noyau. ModeConstants<Mode> renvoie
+// celles de ModeTraits et du modèle : le balayage les replie à la
+// compilation dans le noyau de chaque mode. CellConstants lit celles de
+// CellParams, pour les points de --sensitivity qui les font varier
+template <class Mode>
+struct ModeConstants {
+    static constexpr double interferenceCoeff(const CellParams&) { return ModeTraits<Mode>::kInterferenceCoeff; }
+    static constexpr double variationLow(const CellParams&) { return kVariationLow; }
+    static constexpr double variationSpan(const CellParams&) { return kVariationSpan; }
+    static constexpr double noiseSigma(const CellParams&) { return kNoiseSigma; }
+};
+
+struct CellConstants {
+    static double interferenceCoeff(const CellParams& cell) { return cell.interferenceCoeff; }
+    static double variationLow(const CellParams& cell) { return cell.variationLow; }
+    static double variationSpan(const CellParams& cell) { return cell.variationSpan; }
+    static double noiseSigma(const CellParams& cell) { return cell.noiseSigma; }
+};
+
+// Vrai si le noyau replié du mode donne les mêmes valeurs que CellConstants
+template <class Mode>
+inline bool usesModeConstants(const CellParams& cell) {
+    typedef ModeConstants<Mode> Folded;
+    return cell.interferenceCoeff == Folded::interferenceCoeff(cell)
+        && cell.variationLow == Folded::variationLow(cell)
+        && cell.variationSpan == Folded::variationSpan(cell)
+        && cell.noiseSigma == Folded::noiseSigma(cell);
+}
+
+struct Block {
+    alignas(64) double gridX[kBlockSize];
+    alignas(64) double gridY[kBlockSize];
+    alignas(64) double energy[kBlockSize];
+    alignas(64) double latency[kBlockSize];
+    alignas(64) double interference[kBlockSize];   // entrée, si spatialInterference
+};
+
+// Un appareil recalculé seul (--replay) : tous les facteurs de son énergie
+// et de sa latence
+struct DeviceFactors {
+    double gridX, gridY;
+    double uVariation, uInterference, uRadius, uAngle;
+    double variation;
+    double energyBase, latencyBase;     // base de la cellule + surcoût CE
+    double distanceEffect;
+    double interferenceLoad;
+    double interferenceEffect;
+    double normal, noise;
+    double latencyScale;
+    double energy, latency;
+};
+
+struct BlockSummary {
+    int count;
+    double mean;
+    double m2;
+    double min;
+    double max;
+};
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return "avx512";
+    case Isa::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+} // namespace DeviceKernel
+
+#define NBIOT_ISA_SCALAR 0
+#define NBIOT_ISA_AVX2 1
+#define NBIOT_ISA_AVX512 2
+
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+#define NBIOT_KERNEL_NAMESPACE ScalarKernel
+#define NBIOT_KERNEL_ISA NBIOT_ISA_SCALAR
+#include "device-kernel-impl.h"
+#undef NBIOT_KERNEL_NAMESPACE
+#undef NBIOT_KERNEL_ISA
+
+#if NBIOT_KERNEL_HAS_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define NBIOT_KERNEL_NAMESPACE Avx2Kernel
+#define NBIOT_KERNEL_ISA NBIOT_ISA_AVX2
+#include "device-kernel-impl.h"
+#undef NBIOT_KERNEL_NAMESPACE
+#undef NBIOT_KERNEL_ISA
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define NBIOT_KERNEL_NAMESPACE Avx512Kernel
+#define NBIOT_KERNEL_ISA NBIOT_ISA_AVX512
+#include "device-kernel-impl.h"
+#undef NBIOT_KERNEL_NAMESPACE
+#undef NBIOT_KERNEL_ISA
+#pragma GCC pop_options
+
+#endif
+
+#pragma GCC pop_options
+
+namespace DeviceKernel {
+
+// Meilleur jeu d'instructions disponible sur ce processeur
+inline Isa detectIsa() {
+#if NBIOT_KERNEL_HAS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#endif
+    return Isa::Scalar;
+}
+
+// Demande explicite (--kernel) : "auto" prend le meilleur jeu disponible,
+// un jeu que le processeur ne sait pas exécuter est refusé
+inline Isa resolveIsa(const std::string& requested) {
+    Isa best = detectIsa();
+    if (requested == "auto") return best;
+    if (requested == "scalar") return Isa::Scalar;
+    if (requested == "avx2") {
+        if (best == Isa::Scalar) throw std::invalid_argument("Kernel avx2 is not supported by this CPU");
+        return Isa::Avx2;
+    }
+    if (requested == "avx512") {
+        if (best != Isa::Avx512) throw std::invalid_argument("Kernel avx512 is not supported by this CPU");
+        return Isa::Avx512;
+    }
+    throw std::invalid_argument("Unknown kernel: " + requested);
+}
+
+typedef void (*BlockFunction)(Isa isa, const CellParams& cell, int64_t firstDevice, Block& block);
+typedef DeviceFactors (*ExplainFunction)(const CellParams& cell, int64_t device, double neighbourLoad);
+typedef bool (*FoldCheck)(const CellParams& cell);
+
+template <class Mode, class Constants = ModeConstants<Mode>>
+inline void simulateBlock(Isa isa, const CellParams& cell, int64_t firstDevice,
+                          Block& block) {
+#if NBIOT_KERNEL_HAS_X86
+    if (isa == Isa::Avx512) return Avx512Kernel::simulateBlock<Mode, Constants>(cell, firstDevice, block);
+    if (isa == Isa::Avx2) return Avx2Kernel::simulateBlock<Mode, Constants>(cell, firstDevice, block);
+#endif
+    (void)isa;
+    ScalarKernel::simulateBlock<Mode, Constants>(cell, firstDevice, block);
+}
+
+// Le calcul de simulateBlock pour le seul appareil `device`, en O(1). Les
+// noyaux donnent tous les mêmes bits : la version scalaire suffit
+template <class Mode, class Constants = ModeConstants<Mode>>
+inline DeviceFactors explainDevice(const CellParams& cell, int64_t device, double neighbourLoad) {
+    DeviceFactors out;
+    out.gridX = static_cast<double>(device % cell.gridWidth);
+    out.gridY = static_cast<double>(device / cell.gridWidth);
+    ScalarKernel::Factors f = ScalarKernel::deviceFactors<Mode, Constants>(
+        cell, static_cast<uint64_t>(device), out.gridX, out.gridY, neighbourLoad);
+    out.uVariation = f.uVariation;
+    out.uInterference = f.uInterference;
+    out.uRadius = f.uRadius;
+    out.uAngle = f.uAngle;
+    out.variation = f.variation;
+    out.energyBase = f.energyBase;
+    out.latencyBase = f.latencyBase;
+    out.distanceEffect = f.distanceEffect;
+    out.interferenceLoad = f.interferenceLoad;
+    out.interferenceEffect = f.interferenceEffect;
+    out.normal = f.normal;
+    out.noise = f.noise;
+    out.latencyScale = cell.latencyScale;
+    out.energy = f.energy;
+    out.latency = f.latency;
+    return out;
+}
+
+inline void summarizeBlock(Isa isa, const double* values, int count, BlockSummary& out) {
+#if NBIOT_KERNEL_HAS_X86
+    if (isa == Isa::Avx512) return Avx512Kernel::summarizeBlock(values, count, out);
+    if (isa == Isa::Avx2) return Avx2Kernel::summarizeBlock(values, count, out);
+#endif
+    (void)isa;
+    ScalarKernel::summarizeBlock(values, count, out);
+}
+
+} // namespace DeviceKernel
+
+#endif // NBIOT_DEVICE_KERNEL_H
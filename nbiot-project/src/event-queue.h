@@ -0,0 +1,184 @@
+/*
+ * Event storage and scheduling for the discrete-event access engine
+ *
+ * EventPool hands out fixed-size events from large blocks and recycles them
+ * through a free list, so the simulation loop never calls the allocator.
+ * TimingWheel is a hierarchical timing wheel at 1 µs resolution: level k
+ * has 256 slots of 256^k µs, an event sits at the level of the highest byte
+ * where its time differs from the current time, and moves down when the
+ * clock enters its slot. Insertion and removal are O(1) whatever the spread
+ * of event times, which matters here: in-flight exchanges are a few ms
+ * apart while periodic reports span hours. Events with equal times leave in
+ * insertion order.
+ */
+
+#ifndef NBIOT_EVENT_QUEUE_H
+#define NBIOT_EVENT_QUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct Event {
+    int64_t time;        // µs simulées
+    Event* next;
+    uint64_t target;     // UE ou numéro d'occasion, selon kind
+    uint8_t kind;
+};
+
+class EventPool {
+public:
+    EventPool() : freeList(nullptr) {}
+
+    Event* allocate() {
+        if (freeList == nullptr) refill();
+        Event* event = freeList;
+        freeList = event->next;
+        return event;
+    }
+
+    void release(Event* event) {
+        event->next = freeList;
+        freeList = event;
+    }
+
+private:
+    static const size_t kEventsPerBlock = 4096;
+
+    void refill() {
+        blocks.emplace_back(new Event[kEventsPerBlock]);
+        Event* block = blocks.back().get();
+        for (size_t i = 0; i < kEventsPerBlock; i++) {
+            block[i].next = freeList;
+            freeList = &block[i];
+        }
+    }
+
+    std::vector<std::unique_ptr<Event[]>> blocks;
+    Event* freeList;
+};
+
+class TimingWheel {
+public:
+    TimingWheel() : now(0), count(0) {
+        for (auto& level : occupied) std::fill(level, level + kWords, 0);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Les événements ne sont jamais planifiés avant le dernier dépilé
+    void push(Event* event) {
+        insert(event);
+        count++;
+    }
+
+    Event* pop() {
+        if (count == 0) return nullptr;
+
+        Slot* slot = &slots[0][now & kSlotMask];
+        while (slot->head == nullptr) {
+            advance();
+            slot = &slots[0][now & kSlotMask];
+        }
+
+        Event* event = slot->head;
+        slot->head = event->next;
+        if (slot->head == nullptr) {
+            slot->tail = nullptr;
+            clearBit(0, now & kSlotMask);
+        }
+        count--;
+        return event;
+    }
+
+private:
+    static const int kLevels = 6;                 // 2^48 µs, environ 8,9 ans
+    static const int kSlotBits = 8;
+    static const int kSlots = 1 << kSlotBits;
+    static const int64_t kSlotMask = kSlots - 1;
+    static const int kWords = kSlots / 64;
+
+    struct Slot {
+        Event* head = nullptr;
+        Event* tail = nullptr;
+    };
+
+    static void append(Slot& slot, Event* event) {
+        event->next = nullptr;
+        if (slot.tail != nullptr) {
+            slot.tail->next = event;
+        } else {
+            slot.head = event;
+        }
+        slot.tail = event;
+    }
+
+    void setBit(int level, int64_t index) { occupied[level][index >> 6] |= 1ULL << (index & 63); }
+    void clearBit(int level, int64_t index) { occupied[level][index >> 6] &= ~(1ULL << (index & 63)); }
+
+    // Premier emplacement occupé à partir de from, -1 s'il n'y en a pas
+    int nextOccupied(int level, int from) const {
+        for (int word = from >> 6; word < kWords; word++) {
+            uint64_t bits = occupied[level][word];
+            if (word == from >> 6) bits &= ~0ULL << (from & 63);
+            if (bits != 0) return word * 64 + __builtin_ctzll(bits);
+        }
+        return -1;
+    }
+
+    void insert(Event* event) {
+        uint64_t differing = static_cast<uint64_t>(event->time ^ now);
+        int level = differing == 0 ? 0 : (63 - __builtin_clzll(differing)) / kSlotBits;
+        if (level >= kLevels) {
+            overflow.push_back(event);
+            return;
+        }
+        int64_t index = (event->time >> (level * kSlotBits)) & kSlotMask;
+        append(slots[level][index], event);
+        setBit(level, index);
+    }
+
+    // Avance l'horloge jusqu'au prochain emplacement occupé ; les événements
+    // d'un emplacement de niveau supérieur redescendent vers les roues fines
+    void advance() {
+        for (int level = 0; level < kLevels; level++) {
+            int shift = level * kSlotBits;
+            int next = nextOccupied(level, static_cast<int>((now >> shift) & kSlotMask) + 1);
+            if (next < 0) continue;
+
+            int64_t below = (kSlotMask << shift) | ((int64_t(1) << shift) - 1);
+            now = (now & ~below) | (static_cast<int64_t>(next) << shift);
+            if (level > 0) cascade(level, next);
+            return;
+        }
+
+        // Roues vides : reprise au plus proche des événements lointains
+        std::vector<Event*> pending;
+        pending.swap(overflow);
+        now = pending[0]->time;
+        for (const Event* event : pending) now = std::min(now, event->time);
+        for (Event* event : pending) insert(event);
+    }
+
+    void cascade(int level, int index) {
+        Event* event = slots[level][index].head;
+        slots[level][index] = Slot();
+        clearBit(level, index);
+        while (event != nullptr) {
+            Event* next = event->next;
+            insert(event);
+            event = next;
+        }
+    }
+
+    Slot slots[kLevels][kSlots];
+    uint64_t occupied[kLevels][kWords];
+    std::vector<Event*> overflow;                 // au-delà de la dernière roue
+    int64_t now;
+    size_t count;
+};
+
+#endif // NBIOT_EVENT_QUEUE_H
@@ -0,0 +1,129 @@
+/*
+ * Uniform cell list for neighbour-based interference
+ *
+ * Devices are bucketed by (time slot, square cell of side `range`), so the
+ * transmitters that can interfere with a device are all in the 3x3 block of
+ * cells around it, in its own slot. Each neighbour within range contributes
+ * a weight 2(1 - d²/range²): it falls to zero at the edge of the range and
+ * averages 1 over a uniform disc, so the load of a device is about the
+ * number of co-slot transmitters around it. A full pass costs O(N·k) for k
+ * neighbours per device instead of O(N²).
+ *
+ * moveDevice() and setSlot() update one device in O(1) (swap-remove from its
+ * old bucket), so the index follows mobility or activity changes without a
+ * rebuild. Queries are read-only and may run from several threads at once.
+ */
+
+#ifndef NBIOT_INTERFERENCE_GRID_H
+#define NBIOT_INTERFERENCE_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class InterferenceGrid {
+public:
+    // Zone couverte : [0, width[ x [0, height[ (positions hors zone ramenées au bord)
+    InterferenceGrid(double width, double height, double range, int slots)
+        : range(range), rangeSquared(range * range), slots(slots) {
+        cellsX = std::max(1, static_cast<int>(std::ceil(width / range)));
+        cellsY = std::max(1, static_cast<int>(std::ceil(height / range)));
+        buckets.resize(static_cast<size_t>(slots) * cellsX * cellsY);
+    }
+
+    uint32_t addDevice(double x, double y, int slot) {
+        uint32_t id = static_cast<uint32_t>(devices.size());
+        devices.push_back(Placement());
+        place(id, x, y, slot);
+        return id;
+    }
+
+    void moveDevice(uint32_t id, double x, double y) {
+        unplace(id);
+        place(id, x, y, devices[id].slot);
+    }
+
+    void setSlot(uint32_t id, int slot) {
+        const Entry& entry = buckets[devices[id].bucket][devices[id].position];
+        double x = entry.x, y = entry.y;
+        unplace(id);
+        place(id, x, y, slot);
+    }
+
+    size_t deviceCount() const { return devices.size(); }
+    int slotCount() const { return slots; }
+
+    // Charge d'interférence vue par un appareil (somme des poids des voisins)
+    double interferenceAt(uint32_t id) const {
+        const Placement& device = devices[id];
+        const Entry& self = buckets[device.bucket][device.position];
+        int cx = cellOf(self.x, cellsX), cy = cellOf(self.y, cellsY);
+
+        double load = 0.0;
+        for (int ny = std::max(0, cy - 1); ny <= std::min(cellsY - 1, cy + 1); ny++) {
+            for (int nx = std::max(0, cx - 1); nx <= std::min(cellsX - 1, cx + 1); nx++) {
+                for (const Entry& other : buckets[bucketIndex(device.slot, nx, ny)]) {
+                    double dx = other.x - self.x;
+                    double dy = other.y - self.y;
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 < rangeSquared && other.id != id) {
+                        load += 2.0 * (1.0 - d2 / rangeSquared);
+                    }
+                }
+            }
+        }
+        return load;
+    }
+
+private:
+    // Les positions sont stockées dans les seaux : un parcours de voisinage
+    // ne lit que de la mémoire contiguë
+    struct Entry {
+        double x;
+        double y;
+        uint32_t id;
+    };
+
+    struct Placement {
+        uint32_t bucket;
+        uint32_t position;
+        int slot;
+    };
+
+    int cellOf(double coordinate, int cells) const {
+        int cell = static_cast<int>(coordinate / range);
+        return std::min(std::max(cell, 0), cells - 1);
+    }
+
+    size_t bucketIndex(int slot, int cx, int cy) const {
+        return (static_cast<size_t>(slot) * cellsY + cy) * cellsX + cx;
+    }
+
+    void place(uint32_t id, double x, double y, int slot) {
+        size_t bucket = bucketIndex(slot, cellOf(x, cellsX), cellOf(y, cellsY));
+        Placement& device = devices[id];
+        device.bucket = static_cast<uint32_t>(bucket);
+        device.position = static_cast<uint32_t>(buckets[bucket].size());
+        device.slot = slot;
+        buckets[bucket].push_back({x, y, id});
+    }
+
+    void unplace(uint32_t id) {
+        const Placement& device = devices[id];
+        std::vector<Entry>& bucket = buckets[device.bucket];
+        bucket[device.position] = bucket.back();
+        devices[bucket[device.position].id].position = device.position;
+        bucket.pop_back();
+    }
+
+    double range;
+    double rangeSquared;
+    int slots;
+    int cellsX;
+    int cellsY;
+    std::vector<std::vector<Entry>> buckets;
+    std::vector<Placement> devices;
+};
+
+#endif // NBIOT_INTERFERENCE_GRID_H
@@ -0,0 +1,391 @@
+/*
+ * Event-skipping battery lifetime simulation
+ *
+ * Each UE is stepped from one uplink report to the next until its battery
+ * is empty or the horizon is reached. Nothing happens between two reports
+ * except background drains, so the interval is accounted for in closed form
+ * rather than with fixed time steps:
+ *   - PSM sleep current and battery self-discharge (constant power),
+ *   - eDRX paging occasions (counted from the cycle boundaries crossed),
+ *   - periodic TAUs, due when no report has reset T3412 for a whole period.
+ * A report costs the UE's own report energy. Report energies differ from UE
+ * to UE: they are log-normal, with the mean and spread of the swept cell.
+ *
+ * Traffic profiles: periodic (reports on a fixed grid, each shifted by a
+ * random jitter), Poisson, or Poisson with a diurnal rate (peak in the
+ * afternoon, trough at night, same daily average) drawn by thinning. When
+ * the battery runs out inside an interval, the death time is interpolated
+ * linearly within it.
+ *
+ * Without TAUs the skipping goes further, because the energy used up to a
+ * report then depends only on the report's index and time. For periodic
+ * traffic (T3412 longer than any gap), each report's jitter is drawn
+ * directly from its counter, so the report that empties the battery is found
+ * by bisection in O(log reports) draws. For Poisson and diurnal traffic (a
+ * gap longer than T3412 less likely than 1e-6 over the horizon), 256 reports
+ * are skipped at once: their total duration is Gamma-distributed in
+ * operational time. Only the block where the battery runs out or the horizon
+ * is crossed is expanded. Its inner reports are uniform order statistics on
+ * the block. Diurnal time is mapped through the inverse cumulative rate.
+ * Other cases step report by report.
+ *
+ * Every UE draws from its own counter-based stream; UEs are split into
+ * fixed chunks, so the distribution does not depend on the thread count.
+ */
+
+#ifndef NBIOT_LIFETIME_ENGINE_H
+#define NBIOT_LIFETIME_ENGINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "random-streams.h"
+#include "streaming-stats.h"
+#include "task-pool.h"
+
+enum class TrafficProfile { Periodic, Poisson, Diurnal };
+
+inline TrafficProfile parseTrafficProfile(const std::string& name) {
+    if (name == "periodic") return TrafficProfile::Periodic;
+    if (name == "poisson") return TrafficProfile::Poisson;
+    if (name == "diurnal") return TrafficProfile::Diurnal;
+    throw std::invalid_argument("Unknown traffic profile: " + name);
+}
+
+inline const char* trafficProfileName(TrafficProfile profile) {
+    switch (profile) {
+        case TrafficProfile::Periodic: return "periodic";
+        case TrafficProfile::Poisson: return "poisson";
+        case TrafficProfile::Diurnal: return "diurnal";
+    }
+    return "?";
+}
+
+// Paramètres de la batterie, du trafic et des états de veille (SI sauf mention)
+struct LifetimeConfig {
+    double batteryJ = 18000.0;               // 5 Wh
+    double years = 10.0;                     // horizon simulé
+    double selfDischargePerYear = 0.02;      // fraction de la capacité par an
+
+    TrafficProfile traffic = TrafficProfile::Periodic;
+    double reportsPerDay = 24.0;
+    double jitter = 0.1;                     // périodique : ± fraction de la période (≤ 0,5)
+    double diurnalAmplitude = 0.8;           // diurne : taux × (1 + a·sin)
+
+    double voltage = 3.6;
+    double psmCurrentA = 3e-6;               // plancher en PSM
+    double edrxCycleS = 0.0;                 // 0 : PSM seul, sinon une occasion de paging par cycle
+    double pagingEnergyJ = 0.002;            // écoute d'une occasion de paging
+    double tauPeriodS = 54.0 * 3600.0;       // T3412 étendu ; 0 : pas de TAU
+    double tauEnergyJ = 0.3;                 // une procédure TAU
+};
+
+struct LifetimeResult {
+    RunningStats years;                      // durée de vie par UE (censurée à l'horizon)
+    QuantileSketch yearsSketch;
+    uint64_t survivors = 0;                  // UEs encore en vie à l'horizon
+    uint64_t reports = 0;                    // rapports émis avant la fin de vie
+};
+
+class LifetimeEngine {
+public:
+    static constexpr double kSecondsPerYear = 365.0 * 86400.0;
+    static const int kDevicesPerChunk = 4096;
+    static const int kBlockReports = 256;        // rapports sautés d'un coup (Poisson)
+
+    LifetimeEngine(const LifetimeConfig& config, uint64_t seed) : config(config), seed(seed) {
+        if (config.reportsPerDay <= 0.0 || config.batteryJ <= 0.0 || config.years <= 0.0 ||
+            config.jitter < 0.0 || config.jitter > 0.5) {
+            throw std::invalid_argument("Invalid lifetime configuration");
+        }
+        period = 86400.0 / config.reportsPerDay;
+        horizon = config.years * kSecondsPerYear;
+        floorW = config.psmCurrentA * config.voltage
+               + config.selfDischargePerYear * config.batteryJ / kSecondsPerYear;
+    }
+
+    // numDevices UEs dont l'énergie par rapport suit une log-normale de
+    // moyenne meanReportJ et d'écart type stdDevReportJ
+    LifetimeResult run(int numDevices, double meanReportJ, double stdDevReportJ, TaskPool* pool) const {
+        double ratio = meanReportJ > 0.0 ? stdDevReportJ / meanReportJ : 0.0;
+        double sigma = std::sqrt(std::log1p(ratio * ratio));
+        double mu = std::log(std::max(meanReportJ, 1e-12)) - 0.5 * sigma * sigma;
+
+        int chunkCount = (numDevices + kDevicesPerChunk - 1) / kDevicesPerChunk;
+        std::vector<LifetimeResult> partials(chunkCount);
+        auto simulateChunk = [&](int chunk) {
+            LifetimeResult& partial = partials[chunk];
+            std::vector<double> scratch(kBlockReports);
+            int end = std::min(numDevices, (chunk + 1) * kDevicesPerChunk);
+            for (int device = chunk * kDevicesPerChunk; device < end; device++) {
+                Stream stream{seed, static_cast<uint64_t>(device), 0};
+                double reportJ = std::exp(mu + sigma * stream.normal());
+                uint64_t reports = 0;
+                double lifetime = simulateDevice(stream, reportJ, reports, scratch);
+                double years = lifetime / kSecondsPerYear;
+                partial.years.add(years);
+                partial.yearsSketch.add(years);
+                if (lifetime >= horizon) partial.survivors++;
+                partial.reports += reports;
+            }
+        };
+
+        if (pool != nullptr && chunkCount > 1) {
+            TaskPool::TaskGroup group;
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                pool->submit(group, [&simulateChunk, chunk] { simulateChunk(chunk); });
+            }
+            pool->wait(group);
+        } else {
+            for (int chunk = 0; chunk < chunkCount; chunk++) simulateChunk(chunk);
+        }
+
+        // Fusion dans l'ordre des blocs : indépendante du nombre de threads
+        LifetimeResult result;
+        for (const auto& partial : partials) {
+            result.years.merge(partial.years);
+            result.yearsSketch.merge(partial.yearsSketch);
+            result.survivors += partial.survivors;
+            result.reports += partial.reports;
+        }
+        return result;
+    }
+
+private:
+    // Flux propre à un UE : tirage `counter` accessible directement
+    struct Stream {
+        uint64_t seed;
+        uint64_t device;
+        uint64_t draws;
+
+        double at(uint64_t counter) const {
+            uint64_t out0, out1;
+            RandomStreams::threefry2x64(seed, RandomStreams::kLifetimeDomain, device, counter, out0, out1);
+            return ((out0 >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+
+        double uniform() { return at(draws++); }
+
+        double normal() {
+            double u1 = uniform();
+            double u2 = uniform();
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        }
+
+        // Loi Gamma(shape, 1), shape >= 1 (Marsaglia-Tsang)
+        double gamma(double shape) {
+            double d = shape - 1.0 / 3.0;
+            double c = 1.0 / std::sqrt(9.0 * d);
+            for (;;) {
+                double x = normal();
+                double v = 1.0 + c * x;
+                if (v <= 0.0) continue;
+                v = v * v * v;
+                if (std::log(uniform()) < 0.5 * x * x + d - d * v + d * std::log(v)) return d * v;
+            }
+        }
+    };
+
+    // Tirages 0-1 : énergie du rapport ; 2 : phase ; ensuite le trafic
+    static const uint64_t kTrafficDraws = 3;
+
+    // Taux diurne relatif : maximum à 15 h, minimum à 3 h, moyenne 1
+    double diurnalFactor(double t) const {
+        double hour = std::fmod(t, 86400.0) / 3600.0;
+        return 1.0 + config.diurnalAmplitude * std::sin(6.283185307179586 * (hour - 9.0) / 24.0);
+    }
+
+    // Rapport périodique k : calé sur la grille phase + k·période, décalé
+    // d'au plus jitter·période (les rapports restent dans l'ordre)
+    double periodicReport(const Stream& stream, double phase, int64_t k) const {
+        double offset = config.jitter * (2.0 * stream.at(kTrafficDraws + static_cast<uint64_t>(k)) - 1.0);
+        return phase + (static_cast<double>(k) + offset) * period;
+    }
+
+    double nextReport(Stream& stream, double t) const {
+        if (config.traffic == TrafficProfile::Poisson) return t - period * std::log(stream.uniform());
+        // Diurne : amincissement d'un processus de Poisson au taux maximal
+        double peak = 1.0 + config.diurnalAmplitude;
+        do {
+            t -= period / peak * std::log(stream.uniform());
+        } while (stream.uniform() * peak > diurnalFactor(t));
+        return t;
+    }
+
+    // Temps réel du point s du processus de Poisson de taux 1 (temps
+    // opérationnel) : s·période, ou l'inverse de Λ(t) = ∫ taux diurne / période.
+    // Une journée entière vaut exactement 86400 / période : on se ramène à
+    // une journée puis Newton, borné par la journée, résout le reste
+    double realTime(double s) const {
+        if (config.traffic != TrafficProfile::Diurnal) return s * period;
+        const double omega = 6.283185307179586 / 86400.0;
+        const double shift = 9.0 * 3600.0;
+        const double a = config.diurnalAmplitude;
+        double target = s * period;
+        double day = std::floor(target / 86400.0);
+        double rest = target - day * 86400.0;
+        double low = 0.0, high = 86400.0, u = rest;
+        for (int iteration = 0; iteration < 50; iteration++) {
+            double error = u + a / omega * (std::cos(omega * shift) - std::cos(omega * (u - shift))) - rest;
+            if (error > 0.0) high = u; else low = u;
+            double next = u - error / (1.0 + a * std::sin(omega * (u - shift)));
+            if (!(next > low && next < high)) next = 0.5 * (low + high);
+            if (std::fabs(next - u) < 1e-3) return day * 86400.0 + next;
+            u = next;
+        }
+        return day * 86400.0 + u;
+    }
+
+    // Occasions de paging eDRX dans ]from, to]
+    double pagingOccasions(double from, double to) const {
+        if (config.edrxCycleS <= 0.0) return 0.0;
+        return std::floor(to / config.edrxCycleS) - std::floor(from / config.edrxCycleS);
+    }
+
+    // TAU dus dans ]from, to] quand la dernière émission date de lastUplink
+    double tauCount(double lastUplink, double from, double to) const {
+        if (config.tauPeriodS <= 0.0) return 0.0;
+        return std::floor((to - lastUplink) / config.tauPeriodS)
+             - std::floor((from - lastUplink) / config.tauPeriodS);
+    }
+
+    // Durée de vie en secondes (horizon si la batterie tient)
+    double simulateDevice(Stream& stream, double reportJ, uint64_t& reports, std::vector<double>& scratch) const {
+        double phase = period * stream.at(2);
+        stream.draws = kTrafficDraws;
+        if (config.traffic == TrafficProfile::Periodic) {
+            bool tauPossible = config.tauPeriodS > 0.0 && config.tauPeriodS < period * (1.0 + 2.0 * config.jitter);
+            if (!tauPossible) return periodicLifetime(stream, phase, reportJ, reports);
+        } else {
+            // Un écart entre rapports plus long que T3412 est négligé s'il
+            // a moins d'une chance sur un million de survenir sur l'horizon
+            // (en diurne, une journée entière compte au taux moyen, le reste au taux minimal)
+            double gapReports = config.tauPeriodS / period;
+            if (config.traffic == TrafficProfile::Diurnal) {
+                double days = std::floor(config.tauPeriodS / 86400.0);
+                gapReports = (days * 86400.0 + (config.tauPeriodS - days * 86400.0) * (1.0 - config.diurnalAmplitude)) / period;
+            }
+            double tauPerDevice = horizon / period * std::exp(-gapReports);
+            if (config.tauPeriodS <= 0.0 || tauPerDevice < 1e-6) {
+                return poissonLifetime(stream, reportJ, reports, scratch);
+            }
+        }
+
+        double t = 0.0;
+        double lastUplink = 0.0;
+        int64_t k = 0;
+        double next = config.traffic == TrafficProfile::Periodic ? periodicReport(stream, phase, 0)
+                                                                 : nextReport(stream, 0.0);
+        double used = 0.0;
+        for (;;) {
+            double end = std::min(next, horizon);
+            double cost = floorW * (end - t) + tauCount(lastUplink, t, end) * config.tauEnergyJ
+                        + pagingOccasions(t, end) * config.pagingEnergyJ
+                        + (next <= horizon ? reportJ : 0.0);
+            if (used + cost >= config.batteryJ) {
+                return t + (end - t) * (config.batteryJ - used) / cost;
+            }
+            if (next > horizon) return horizon;
+
+            used += cost;
+            reports++;
+            t = next;
+            lastUplink = next;
+            next = config.traffic == TrafficProfile::Periodic ? periodicReport(stream, phase, ++k)
+                                                              : nextReport(stream, t);
+        }
+    }
+
+    // Trafic périodique sans TAU : l'énergie consommée au rapport k ne dépend
+    // que de son instant, E(k) = plancher·t_k + (k+1)·rapport + paging(0, t_k).
+    // E est croissante : la fin de vie se trouve par dichotomie sur k, en
+    // O(log n) tirages au lieu d'un pas par rapport
+    double periodicLifetime(const Stream& stream, double phase, double reportJ, uint64_t& reports) const {
+        auto energyAt = [&](double t, int64_t reportCount) {
+            return floorW * t + static_cast<double>(reportCount) * reportJ
+                 + pagingOccasions(0.0, t) * config.pagingEnergyJ;
+        };
+
+        // Dernier rapport avant l'horizon (-1 : aucun)
+        int64_t last = static_cast<int64_t>(std::floor((horizon - phase) / period));
+        while (last >= 0 && periodicReport(stream, phase, last) > horizon) last--;
+        while (periodicReport(stream, phase, last + 1) <= horizon) last++;
+
+        if (energyAt(horizon, last + 1) < config.batteryJ) {
+            reports += static_cast<uint64_t>(last + 1);
+            return horizon;
+        }
+
+        // Premier rapport k (ou l'horizon, k = last + 1) où la batterie est vide
+        int64_t low = 0, high = last + 1;
+        while (low < high) {
+            int64_t middle = low + (high - low) / 2;
+            if (energyAt(periodicReport(stream, phase, middle), middle + 1) >= config.batteryJ) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        double end = low <= last ? periodicReport(stream, phase, low) : horizon;
+        double endEnergy = low <= last ? energyAt(end, low + 1) : energyAt(horizon, last + 1);
+        double start = low > 0 ? periodicReport(stream, phase, low - 1) : 0.0;
+        double startEnergy = low > 0 ? energyAt(start, low) : 0.0;
+        reports += static_cast<uint64_t>(low);
+        return start + (end - start) * (config.batteryJ - startEnergy) / (endEnergy - startEnergy);
+    }
+
+    // Poisson et diurne sans TAU : en temps opérationnel, la durée de
+    // kBlockReports écarts suit une loi Gamma(kBlockReports) et l'énergie d'un
+    // bloc ne dépend que de ses extrémités. Seul le bloc où la batterie se
+    // vide (ou qui franchit l'horizon) est détaillé : sachant sa durée, ses
+    // rapports intermédiaires sont des uniformes ordonnées sur le bloc
+    double poissonLifetime(Stream& stream, double reportJ, uint64_t& reports, std::vector<double>& scratch) const {
+        double s = 0.0;
+        double t = 0.0;
+        double used = 0.0;
+        for (;;) {
+            double blockEnd = s + stream.gamma(kBlockReports);
+            double end = realTime(blockEnd);
+            double cost = floorW * (end - t) + pagingOccasions(t, end) * config.pagingEnergyJ
+                        + kBlockReports * reportJ;
+            if (end <= horizon && used + cost < config.batteryJ) {
+                used += cost;
+                reports += kBlockReports;
+                s = blockEnd;
+                t = end;
+                continue;
+            }
+
+            for (int i = 0; i < kBlockReports - 1; i++) scratch[i] = s + (blockEnd - s) * stream.uniform();
+            std::sort(scratch.begin(), scratch.end() - 1);
+            scratch[kBlockReports - 1] = blockEnd;
+            for (double point : scratch) {
+                double next = realTime(point);
+                double stop = std::min(next, horizon);
+                double step = floorW * (stop - t) + pagingOccasions(t, stop) * config.pagingEnergyJ
+                            + (next <= horizon ? reportJ : 0.0);
+                if (used + step >= config.batteryJ) {
+                    return t + (stop - t) * (config.batteryJ - used) / step;
+                }
+                if (next > horizon) return horizon;
+                used += step;
+                reports++;
+                t = next;
+            }
+            // Arrondi : le bloc détaillé a consommé un peu moins que le bloc entier
+            return t;
+        }
+    }
+
+    LifetimeConfig config;
+    uint64_t seed;
+    double period;
+    double horizon;
+    double floorW;
+};
+
+#endif // NBIOT_LIFETIME_ENGINE_H
@@ -0,0 +1,65 @@
+/*
+ * Transmission mode policies
+ *
+ * Each mode is an empty tag type; its parameters live in a ModeTraits
+ * specialisation as compile-time constants. The device kernel is
+ * instantiated once per mode with the procedure and the interference
+ * coefficient folded in (DeviceKernel::ModeConstants), so the per-device loop
+ * never looks at the mode name. Energy and latency ranges are used once per
+ * cell through the mode's descriptor. --sensitivity points that change a
+ * constant run a second instantiation that reads it from CellParams. To add
+ * a mode: declare a tag, specialise ModeTraits, and register it in
+ * ModeRegistry (mode-registry.h).
+ */
+
+#ifndef NBIOT_MODE_POLICIES_H
+#define NBIOT_MODE_POLICIES_H
+
+// Procédure d'accès suivie par le moteur à événements discrets
+enum class AccessProcedure {
+    RandomAccess,       // RA complet puis connexion RRC et données
+    EarlyData,          // données dans Msg3, pas de connexion
+    Preconfigured       // données sur ressource PUR dédiée, sans RA
+};
+
+struct RapMode {};  // Random Access Procedure
+struct EdtMode {};  // Early Data Transmission
+struct PurMode {};  // Preconfigured Uplink Resources
+
+template <class Mode>
+struct ModeTraits;
+
+template <>
+struct ModeTraits<RapMode> {
+    static constexpr const char* kName = "RAP";
+    static constexpr AccessProcedure kProcedure = AccessProcedure::RandomAccess;
+    static constexpr double kEnergyMin = 4.0;           // 4.0-6.0 J
+    static constexpr double kEnergySpan = 2.0;
+    static constexpr double kLatencyMin = 400.0;        // 400-600 ms
+    static constexpr double kLatencySpan = 200.0;
+    static constexpr double kInterferenceCoeff = 0.3;
+};
+
+template <>
+struct ModeTraits<EdtMode> {
+    static constexpr const char* kName = "EDT";
+    static constexpr AccessProcedure kProcedure = AccessProcedure::EarlyData;
+    static constexpr double kEnergyMin = 3.0;           // 3.0-4.5 J
+    static constexpr double kEnergySpan = 1.5;
+    static constexpr double kLatencyMin = 200.0;        // 200-300 ms
+    static constexpr double kLatencySpan = 100.0;
+    static constexpr double kInterferenceCoeff = 0.2;
+};
+
+template <>
+struct ModeTraits<PurMode> {
+    static constexpr const char* kName = "PUR";
+    static constexpr AccessProcedure kProcedure = AccessProcedure::Preconfigured;
+    static constexpr double kEnergyMin = 2.0;           // 2.0-3.0 J
+    static constexpr double kEnergySpan = 1.0;
+    static constexpr double kLatencyMin = 100.0;        // 100-180 ms
+    static constexpr double kLatencySpan = 80.0;
+    static constexpr double kInterferenceCoeff = 0.1;
+};
+
+#endif // NBIOT_MODE_POLICIES_H
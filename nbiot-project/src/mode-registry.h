@@ -0,0 +1,87 @@
+/*
+ * Registry of transmission modes
+ *
+ * Maps a mode name to its descriptor: the ModeTraits constants (copied for
+ * the once-per-cell code) and the device kernel instantiated for that mode,
+ * with its single-device variant for --replay. The sweep runs the kernel
+ * with the mode's constants folded in; --sensitivity points that change
+ * them run the variant that reads them from CellParams.
+ * The name is looked up once per cell; the kernel itself never sees it.
+ */
+
+#ifndef NBIOT_MODE_REGISTRY_H
+#define NBIOT_MODE_REGISTRY_H
+
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+#include "device-kernel.h"
+#include "mode-policies.h"
+
+struct ModeDescriptor {
+    std::string name;
+    double energyMin;
+    double energySpan;
+    double latencyMin;
+    double latencySpan;
+    double interferenceCoeff;
+    AccessProcedure procedure;
+    DeviceKernel::BlockFunction simulateBlock;          // constantes de ModeTraits repliées
+    DeviceKernel::BlockFunction simulateBlockRuntime;   // constantes lues dans CellParams
+    DeviceKernel::FoldCheck usesModeConstants;          // simulateBlock convient-il à la cellule ?
+    DeviceKernel::ExplainFunction explainDevice;
+};
+
+class ModeRegistry {
+public:
+    static ModeRegistry& instance() {
+        static ModeRegistry registry;
+        return registry;
+    }
+
+    template <class Mode>
+    void add() {
+        typedef ModeTraits<Mode> Traits;
+        ModeDescriptor descriptor;
+        descriptor.name = Traits::kName;
+        descriptor.energyMin = Traits::kEnergyMin;
+        descriptor.energySpan = Traits::kEnergySpan;
+        descriptor.latencyMin = Traits::kLatencyMin;
+        descriptor.latencySpan = Traits::kLatencySpan;
+        descriptor.interferenceCoeff = Traits::kInterferenceCoeff;
+        descriptor.procedure = Traits::kProcedure;
+        descriptor.simulateBlock = &DeviceKernel::simulateBlock<Mode>;
+        descriptor.simulateBlockRuntime = &DeviceKernel::simulateBlock<Mode, DeviceKernel::CellConstants>;
+        descriptor.usesModeConstants = &DeviceKernel::usesModeConstants<Mode>;
+        descriptor.explainDevice = &DeviceKernel::explainDevice<Mode>;
+        descriptors.push_back(descriptor);
+    }
+
+    const ModeDescriptor* find(const std::string& name) const {
+        for (const auto& descriptor : descriptors) {
+            if (descriptor.name == name) return &descriptor;
+        }
+        return nullptr;
+    }
+
+    const ModeDescriptor& get(const std::string& name) const {
+        const ModeDescriptor* descriptor = find(name);
+        if (descriptor == nullptr) throw std::invalid_argument("Unknown transmission mode: " + name);
+        return *descriptor;
+    }
+
+    const std::deque<ModeDescriptor>& modes() const { return descriptors; }
+
+private:
+    ModeRegistry() {
+        add<RapMode>();
+        add<EdtMode>();
+        add<PurMode>();
+    }
+
+    // deque : les pointeurs renvoyés par find() restent valides après add()
+    std::deque<ModeDescriptor> descriptors;
+};
+
+#endif // NBIOT_MODE_REGISTRY_H
@@ -0,0 +1,313 @@
+/*
+ * Low-overhead instrumentation for the simulation hot paths
+ *
+ * NBIOT_PROFILE_SCOPE("name") times the enclosing block and
+ * NBIOT_PROFILE_COUNTER("name", value) records a value. Each thread appends
+ * its records to its own ring buffer (no lock, no allocation once the buffer
+ * exists) and keeps exact per-name totals next to it. When the ring is full
+ * the oldest records are overwritten, but the totals stay complete.
+ *
+ * Compile time: -DNBIOT_NO_PROFILING turns both macros into nothing.
+ * Runtime: nothing is recorded until enable(); while disabled a scope costs
+ * one relaxed atomic load.
+ *
+ * writeChromeTrace() produces a trace-event JSON file for Perfetto or
+ * chrome://tracing; printSummary() prints per-phase totals. Both read the
+ * buffers of every thread and must only be called once the recorded work
+ * has finished (after TaskPool::wait).
+ */
+
+#ifndef NBIOT_PROFILER_H
+#define NBIOT_PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Profiler {
+
+#ifdef NBIOT_NO_PROFILING
+const bool kCompiledIn = false;
+#else
+const bool kCompiledIn = true;
+#endif
+
+enum class Kind : uint8_t { Scope, Counter };
+
+struct Record {
+    const char* name;     // littéral : seul le pointeur est copié
+    int64_t start;        // ns depuis le lancement du programme
+    int64_t duration;     // ns (Scope)
+    int64_t value;        // Counter
+    Kind kind;
+};
+
+struct Total {
+    const char* name;
+    Kind kind;
+    uint64_t calls;
+    int64_t sum;          // ns pour un Scope, somme des valeurs pour un Counter
+    int64_t max;
+};
+
+// Tampon d'un thread : un seul écrivain, lu seulement une fois le travail fini
+class ThreadLog {
+public:
+    ThreadLog(uint32_t id, size_t capacity) : id(id), ring(capacity), written(0) {}
+
+    void add(const Record& record) {
+        ring[written % ring.size()] = record;
+        written++;
+
+        int64_t amount = record.kind == Kind::Scope ? record.duration : record.value;
+        for (auto& total : totals) {
+            if (total.name == record.name) {
+                total.calls++;
+                total.sum += amount;
+                total.max = std::max(total.max, amount);
+                return;
+            }
+        }
+        totals.push_back({record.name, record.kind, 1, amount, amount});
+    }
+
+    void clear() {
+        written = 0;
+        totals.clear();
+    }
+
+    const uint32_t id;
+    std::vector<Record> ring;
+    uint64_t written;
+    std::vector<Total> totals;
+};
+
+struct State {
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    int64_t enabledAt = 0;
+    int64_t disabledAt = 0;
+    size_t capacity = 1 << 16;
+    uint32_t mainThread = 0;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadLog>> logs;   // jamais libérés : les threads gardent un pointeur
+};
+
+inline State& state() {
+    static State instance;
+    return instance;
+}
+
+inline int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - state().epoch).count();
+}
+
+inline bool enabled() { return state().enabled.load(std::memory_order_relaxed); }
+
+inline ThreadLog& threadLog() {
+    thread_local ThreadLog* log = nullptr;
+    if (log == nullptr) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.logs.emplace_back(new ThreadLog(static_cast<uint32_t>(s.logs.size()), s.capacity));
+        log = s.logs.back().get();
+    }
+    return *log;
+}
+
+// Records conservés par thread (les plus anciens sont écrasés au-delà) ;
+// s'applique aux threads qui n'ont encore rien enregistré
+inline void setBufferCapacity(size_t records) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.capacity = std::max<size_t>(records, 1);
+}
+
+// Efface les enregistrements précédents et démarre la collecte ; le
+// thread appelant apparaît comme « main » dans la trace
+inline void enable() {
+    if (!kCompiledIn) return;
+    State& s = state();
+    uint32_t caller = threadLog().id;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (auto& log : s.logs) log->clear();
+        s.mainThread = caller;
+    }
+    s.enabledAt = now();
+    s.disabledAt = 0;
+    s.enabled.store(true, std::memory_order_release);
+}
+
+inline void disable() {
+    State& s = state();
+    if (s.enabled.exchange(false, std::memory_order_acq_rel)) s.disabledAt = now();
+}
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name(enabled() ? name : nullptr), start(0) {
+        if (this->name != nullptr) start = now();
+    }
+
+    ~Scope() {
+        if (name != nullptr) threadLog().add({name, start, now() - start, 0, Kind::Scope});
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    int64_t start;
+};
+
+inline void counter(const char* name, int64_t value) {
+    if (enabled()) threadLog().add({name, now(), 0, value, Kind::Counter});
+}
+
+// Durée couverte par la collecte (jusqu'à maintenant si elle est en cours)
+inline int64_t wallTime() {
+    const State& s = state();
+    return (s.disabledAt > 0 ? s.disabledAt : now()) - s.enabledAt;
+}
+
+// Totaux de tous les threads, fusionnés par nom
+inline std::vector<Total> totals() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::map<std::string, Total> merged;
+    for (const auto& log : s.logs) {
+        for (const auto& total : log->totals) {
+            auto found = merged.find(total.name);
+            if (found == merged.end()) {
+                merged.emplace(total.name, total);
+            } else {
+                found->second.calls += total.calls;
+                found->second.sum += total.sum;
+                found->second.max = std::max(found->second.max, total.max);
+            }
+        }
+    }
+    std::vector<Total> result;
+    for (const auto& entry : merged) result.push_back(entry.second);
+    std::sort(result.begin(), result.end(), [](const Total& a, const Total& b) {
+        return a.kind != b.kind ? a.kind < b.kind : a.sum > b.sum;
+    });
+    return result;
+}
+
+inline void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+// Format « trace event » : événements complets (ph X) et compteurs (ph C)
+inline void writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot create " + path);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    bool first = true;
+    for (const auto& log : s.logs) {
+        if (log->written == 0) continue;
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << log->id << ",\"args\":{\"name\":\""
+            << (log->id == s.mainThread ? "main" : "thread " + std::to_string(log->id)) << "\"}}";
+        first = false;
+
+        size_t capacity = log->ring.size();
+        uint64_t begin = log->written > capacity ? log->written - capacity : 0;
+        for (uint64_t i = begin; i < log->written; i++) {
+            const Record& record = log->ring[i % capacity];
+            out << ",\n{\"name\":";
+            writeJsonString(out, record.name);
+            if (record.kind == Kind::Scope) {
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << log->id << ",\"ts\":"
+                    << (record.start - s.enabledAt) / 1000.0 << ",\"dur\":" << record.duration / 1000.0 << "}";
+            } else {
+                out << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << log->id << ",\"ts\":"
+                    << (record.start - s.enabledAt) / 1000.0 << ",\"args\":{\"value\":" << record.value << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    if (!out) throw std::runtime_error("Error while writing " + path);
+}
+
+// Records écrasés faute de place dans les anneaux
+inline uint64_t droppedRecords() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    uint64_t dropped = 0;
+    for (const auto& log : s.logs) {
+        if (log->written > log->ring.size()) dropped += log->written - log->ring.size();
+    }
+    return dropped;
+}
+
+inline void printSummary(std::ostream& out) {
+    std::vector<Total> all = totals();
+    double wallMs = wallTime() / 1e6;
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(28) << "phase" << std::right << std::setw(12) << "calls"
+        << std::setw(14) << "total ms" << std::setw(12) << "mean us" << std::setw(12) << "max us"
+        << std::setw(10) << "% wall" << std::endl;
+    for (const auto& total : all) {
+        if (total.kind != Kind::Scope) continue;
+        out << std::left << std::setw(28) << total.name << std::right << std::setw(12) << total.calls
+            << std::setw(14) << total.sum / 1e6
+            << std::setw(12) << total.sum / 1e3 / total.calls
+            << std::setw(12) << total.max / 1e3
+            << std::setw(10) << std::setprecision(1) << (wallMs > 0 ? 100.0 * total.sum / 1e6 / wallMs : 0.0)
+            << std::setprecision(3) << std::endl;
+    }
+    for (const auto& total : all) {
+        if (total.kind != Kind::Counter) continue;
+        out << std::left << std::setw(28) << total.name << std::right << std::setw(12) << total.calls
+            << "  total " << total.sum << std::endl;
+    }
+    out << "Wall time " << wallMs << " ms; phases on worker threads add up across threads";
+    uint64_t dropped = droppedRecords();
+    if (dropped > 0) out << "; " << dropped << " oldest records dropped from the trace";
+    out << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace Profiler
+
+#define NBIOT_PROFILE_CONCAT_INNER(a, b) a##b
+#define NBIOT_PROFILE_CONCAT(a, b) NBIOT_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef NBIOT_NO_PROFILING
+#define NBIOT_PROFILE_SCOPE(name) ((void)0)
+#define NBIOT_PROFILE_COUNTER(name, value) ((void)0)
+#else
+#define NBIOT_PROFILE_SCOPE(name) Profiler::Scope NBIOT_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define NBIOT_PROFILE_COUNTER(name, value) Profiler::counter(name, static_cast<int64_t>(value))
+#endif
+
+#endif // NBIOT_PROFILER_H
@@ -0,0 +1,139 @@
+/*
+ * Preconfigured uplink resource (PUR) planner
+ *
+ * Each PUR UE owns one NPUSCH resource per PUR period: a time slot (one PUR
+ * transmission long) on one of the single-tone subcarriers reserved for PUR.
+ * A UE asks for the first slot after its report is ready and gets the
+ * earliest free resource from there, wrapping around the period. When every
+ * resource is taken the cell is full and the UE is left without PUR; it then
+ * falls back to early data transmission.
+ *
+ * Resources are numbered time-major (slot · tones + tone), so "earliest free
+ * resource from slot s" is "first clear bit from s · tones" in an occupancy
+ * bitmap. The bitmap is hierarchical: a bit of level k + 1 is set when the
+ * 64-bit word below it is full. A search walks up until it finds a word that
+ * is not full, then down along the first clear bits. Assigning and releasing
+ * cost O(log64 capacity), so planning a cell is linear in its UE count, and
+ * UEs can join or leave a plan without re-planning the others.
+ */
+
+#ifndef NBIOT_PUR_PLANNER_H
+#define NBIOT_PUR_PLANNER_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Bitmap d'occupation à plusieurs niveaux (1 = occupé)
+class OccupancyBitmap {
+public:
+    explicit OccupancyBitmap(uint64_t size) : bits(size) {
+        uint64_t count = size;
+        do {
+            uint64_t words = (count + 63) / 64;
+            levels.emplace_back(words, 0);
+            // Les bits au-delà de la fin comptent comme occupés
+            if (count % 64 != 0) levels.back().back() = ~0ULL << (count % 64);
+            count = words;
+        } while (count > 1);
+    }
+
+    uint64_t size() const { return bits; }
+
+    void set(uint64_t index) {
+        for (size_t level = 0; level < levels.size(); level++) {
+            uint64_t& word = levels[level][index / 64];
+            word |= 1ULL << (index % 64);
+            if (word != ~0ULL) return;
+            index /= 64;
+        }
+    }
+
+    void clear(uint64_t index) {
+        for (size_t level = 0; level < levels.size(); level++) {
+            uint64_t& word = levels[level][index / 64];
+            bool wasFull = word == ~0ULL;
+            word &= ~(1ULL << (index % 64));
+            if (!wasFull) return;
+            index /= 64;
+        }
+    }
+
+    // Premier bit libre >= from, size() s'il n'y en a pas
+    uint64_t findFree(uint64_t from) const {
+        if (from >= bits) return bits;
+        uint64_t index = from;
+        size_t level = 0;
+        for (;;) {
+            // Les bits avant index comptent comme occupés
+            uint64_t word = levels[level][index / 64] | ((1ULL << (index % 64)) - 1);
+            if (word != ~0ULL) {
+                index = (index & ~63ULL) + __builtin_ctzll(~word);
+                break;
+            }
+            if (level + 1 == levels.size()) return bits;
+            index = index / 64 + 1;
+            level++;
+            if (index >= levels[level - 1].size()) return bits;
+        }
+        // Descente : chaque bit libre désigne un mot non plein du niveau inférieur
+        while (level > 0) {
+            level--;
+            index = index * 64 + __builtin_ctzll(~levels[level][index]);
+        }
+        return index;
+    }
+
+private:
+    uint64_t bits;
+    std::vector<std::vector<uint64_t>> levels;
+};
+
+class PurPlanner {
+public:
+    static const uint32_t kNone = 0xFFFFFFFFu;
+
+    PurPlanner(uint32_t slotsPerPeriod, uint32_t tones, uint32_t maxUes)
+        : slots(slotsPerPeriod), tones(tones), occupancy(static_cast<uint64_t>(slotsPerPeriod) * tones),
+          resourceOf(maxUes, kNone), used(0) {
+        if (slotsPerPeriod == 0 || tones == 0) throw std::invalid_argument("Empty PUR resource grid");
+        if (occupancy.size() >= kNone) throw std::invalid_argument("Too many PUR resources");
+    }
+
+    // Ressource de l'UE au premier créneau libre à partir de `desiredSlot`
+    // (circulaire) ; kNone si la cellule est pleine
+    uint32_t assign(uint32_t ue, uint32_t desiredSlot) {
+        if (resourceOf[ue] != kNone) release(ue);
+        uint64_t resource = occupancy.findFree(static_cast<uint64_t>(desiredSlot % slots) * tones);
+        if (resource == occupancy.size()) resource = occupancy.findFree(0);
+        if (resource == occupancy.size()) return kNone;
+        occupancy.set(resource);
+        resourceOf[ue] = static_cast<uint32_t>(resource);
+        used++;
+        return static_cast<uint32_t>(resource);
+    }
+
+    void release(uint32_t ue) {
+        if (resourceOf[ue] == kNone) return;
+        occupancy.clear(resourceOf[ue]);
+        resourceOf[ue] = kNone;
+        used--;
+    }
+
+    bool hasResource(uint32_t ue) const { return resourceOf[ue] != kNone; }
+    uint32_t slotOf(uint32_t ue) const { return resourceOf[ue] / tones; }
+    uint32_t toneOf(uint32_t ue) const { return resourceOf[ue] % tones; }
+
+    uint32_t slotsPerPeriod() const { return slots; }
+    uint64_t capacity() const { return occupancy.size(); }
+    uint64_t assigned() const { return used; }
+
+private:
+    uint32_t slots;
+    uint32_t tones;
+    OccupancyBitmap occupancy;
+    std::vector<uint32_t> resourceOf;    // ressource de chaque UE, kNone sans PUR
+    uint64_t used;
+};
+
+#endif // NBIOT_PUR_PLANNER_H
@@ -0,0 +1,118 @@
+/*
+ * Independent random streams for parallel simulations
+ *
+ * Every (mode, deviceCount, repeat) cell gets its own seed derived from the
+ * master seed. Inside a cell, draws come from the counter-based Threefry-2x64
+ * generator (Salmon et al., Random123): the device index is the counter, so
+ * any device can be drawn independently of the others, in any order, and the
+ * results never depend on the number of threads.
+ */
+
+#ifndef NBIOT_RANDOM_STREAMS_H
+#define NBIOT_RANDOM_STREAMS_H
+
+#include <cstdint>
+#include <string>
+
+namespace RandomStreams {
+
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Combine une graine et une valeur en une nouvelle graine décorrélée
+inline uint64_t mixSeed(uint64_t seed, uint64_t value) {
+    return splitMix64(seed ^ splitMix64(value));
+}
+
+// Hash FNV-1a : identifiant stable d'un mode, indépendant de sa position
+inline uint64_t hashName(const std::string& name) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+inline uint64_t cellSeed(uint64_t masterSeed, const std::string& mode,
+                         int numDevices, int repeat) {
+    uint64_t seed = mixSeed(masterSeed, hashName(mode));
+    seed = mixSeed(seed, static_cast<uint64_t>(numDevices));
+    return mixSeed(seed, static_cast<uint64_t>(repeat));
+}
+
+// Domaines de compteur : tirages par appareil / tirages de la cellule /
+// tirages par UE du moteur à événements discrets / créneau d'émission
+// de chaque appareil (interférence spatiale) / durée de vie de la batterie
+const uint64_t kDeviceDomain = 0;
+const uint64_t kCellDomain = 1;
+const uint64_t kAccessDomain = 2;
+const uint64_t kInterferenceDomain = 3;
+const uint64_t kLifetimeDomain = 4;
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Threefry-2x64, 20 tours ; renvoie 128 bits pour (clé, compteur)
+inline void threefry2x64(uint64_t key0, uint64_t key1,
+                         uint64_t counter0, uint64_t counter1,
+                         uint64_t& out0, uint64_t& out1) {
+    static const int kRotations[8] = {16, 42, 12, 31, 16, 32, 24, 21};
+    const uint64_t ks[3] = {key0, key1, key0 ^ key1 ^ 0x1BD11BDAA9FC1A22ULL};
+
+    uint64_t x0 = counter0 + ks[0];
+    uint64_t x1 = counter1 + ks[1];
+    for (int round = 0; round < 20; round++) {
+        x0 += x1;
+        x1 = rotl64(x1, kRotations[round % 8]) ^ x0;
+        if (round % 4 == 3) {
+            uint64_t s = round / 4 + 1;
+            x0 += ks[s % 3];
+            x1 += ks[(s + 1) % 3] + s;
+        }
+    }
+    out0 = x0;
+    out1 = x1;
+}
+
+// Uniforme dans ]0, 1[ à partir de 32 bits aléatoires
+inline double uniformFromBits(uint32_t bits) {
+    return (bits + 0.5) * (1.0 / 4294967296.0);
+}
+
+// Tirages de niveau cellule (paramètres de base, variation finale) ; le
+// flux antithétique renvoie 1 - u pour chaque tirage u du flux normal
+class CellStream {
+public:
+    explicit CellStream(uint64_t seed, bool antithetic = false)
+        : seed(seed), counter(0), buffered{}, available(0), flip(antithetic ? 0xFFFFFFFFu : 0u) {}
+
+    double uniform() {
+        if (available == 0) {
+            uint64_t out0, out1;
+            threefry2x64(seed, kCellDomain, counter++, 0, out0, out1);
+            buffered[0] = static_cast<uint32_t>(out0);
+            buffered[1] = static_cast<uint32_t>(out0 >> 32);
+            buffered[2] = static_cast<uint32_t>(out1);
+            buffered[3] = static_cast<uint32_t>(out1 >> 32);
+            available = 4;
+        }
+        return uniformFromBits(buffered[4 - available--] ^ flip);
+    }
+
+private:
+    uint64_t seed;
+    uint64_t counter;
+    uint32_t buffered[4];
+    int available;
+    uint32_t flip;
+};
+
+} // namespace RandomStreams
+
+#endif // NBIOT_RANDOM_STREAMS_H
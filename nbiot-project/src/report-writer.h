@@ -0,0 +1,439 @@
+/*
+ * Native report stage: SVG charts, HTML page and text summary
+ *
+ * Draws the four panels the old generate_graphs.py produced (energy with
+ * error bars, latency, battery life, PUR energy savings vs RAP) straight
+ * from the in-memory results, plus simulation_report.txt. No interpreter,
+ * no CSV round trip, nothing that can block on a display.
+ */
+
+#ifndef NBIOT_REPORT_WRITER_H
+#define NBIOT_REPORT_WRITER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Report {
+
+// Une ligne du tableau de résultats (moyenne des répétitions d'une cellule)
+struct Row {
+    std::string mode;
+    int devices;
+    double energy;
+    double energyStdDev;
+    double latency;
+    double batteryLife;
+};
+
+enum class Marker { Circle, Square, Triangle };
+
+struct Series {
+    std::string mode;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> error;       // vide : pas de barres d'erreur
+};
+
+inline std::string format(double value, int decimals) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    return buffer;
+}
+
+inline std::string escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+// Mêmes couleurs que le script Python, puis une palette pour les autres modes
+inline std::string modeColor(const std::string& mode, size_t index) {
+    static const std::map<std::string, std::string> known = {
+        {"RAP", "#E74C3C"}, {"EDT", "#3498DB"}, {"PUR", "#2ECC71"}};
+    static const char* palette[] = {"#9B59B6", "#F39C12", "#1ABC9C", "#34495E", "#D35400"};
+    auto it = known.find(mode);
+    if (it != known.end()) return it->second;
+    return palette[index % (sizeof(palette) / sizeof(palette[0]))];
+}
+
+// Graduations « rondes » (1, 2, 5 × 10^k) couvrant [low, high]
+inline std::vector<double> niceTicks(double low, double high, int target = 5) {
+    if (!(high > low)) high = low + 1.0;
+    double raw = (high - low) / target;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    double normalized = raw / magnitude;
+    double step = (normalized < 1.5 ? 1.0 : normalized < 3.0 ? 2.0 : normalized < 7.0 ? 5.0 : 10.0)
+                * magnitude;
+
+    std::vector<double> ticks;
+    double first = std::floor(low / step) * step;
+    double last = std::ceil(high / step) * step;
+    for (double tick = first; tick <= last + step * 0.5; tick += step) ticks.push_back(tick);
+    return ticks;
+}
+
+inline int tickDecimals(const std::vector<double>& ticks) {
+    double step = ticks.size() > 1 ? ticks[1] - ticks[0] : 1.0;
+    return step >= 1.0 ? 0 : static_cast<int>(std::ceil(-std::log10(step)));
+}
+
+// Zone de tracé d'un panneau et conversions données → pixels
+struct Frame {
+    double left, top, width, height;
+    double xMin, xMax, yMin, yMax;
+    bool logX;
+
+    double px(double x) const {
+        double t = logX ? (std::log10(x) - std::log10(xMin)) / (std::log10(xMax) - std::log10(xMin))
+                        : (x - xMin) / (xMax - xMin);
+        return left + t * width;
+    }
+    double py(double y) const { return top + height - (y - yMin) / (yMax - yMin) * height; }
+};
+
+class SvgReport {
+public:
+    static const int kWidth = 1400;
+    static const int kHeight = 1000;
+
+    explicit SvgReport(const std::vector<Row>& rows) : rows(rows) {
+        for (const auto& row : rows) {
+            if (std::find(modes.begin(), modes.end(), row.mode) == modes.end()) modes.push_back(row.mode);
+            if (std::find(deviceCounts.begin(), deviceCounts.end(), row.devices) == deviceCounts.end()) {
+                deviceCounts.push_back(row.devices);
+            }
+        }
+        std::sort(deviceCounts.begin(), deviceCounts.end());
+    }
+
+    std::string svg() const {
+        std::ostringstream out;
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << kWidth << "\" height=\""
+            << kHeight << "\" viewBox=\"0 0 " << kWidth << ' ' << kHeight
+            << "\" font-family=\"Helvetica, Arial, sans-serif\" font-size=\"13\">\n";
+        out << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+
+        linePanel(out, 0, 0, "Real Energy Consumption with Error Bars", "Energy Consumption (J/UE)",
+                  Marker::Circle, [](const Row& r) { return r.energy; },
+                  [](const Row& r) { return r.energyStdDev; });
+        linePanel(out, kWidth / 2, 0, "End-to-End Latency Comparison", "Latency (ms)",
+                  Marker::Square, [](const Row& r) { return r.latency; }, nullptr);
+        linePanel(out, 0, kHeight / 2, "Estimated Battery Life", "Battery Life (years)",
+                  Marker::Triangle, [](const Row& r) { return r.batteryLife; }, nullptr);
+        savingsPanel(out, kWidth / 2, kHeight / 2);
+
+        out << "</svg>\n";
+        return out.str();
+    }
+
+    // Page autonome : graphiques en ligne et tableau des moyennes par mode
+    std::string html() const {
+        std::ostringstream out;
+        out << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+            << "<title>NB-IoT simulation results</title>"
+            << "<style>body{font-family:Helvetica,Arial,sans-serif;margin:24px}"
+            << "table{border-collapse:collapse}td,th{border:1px solid #ccc;padding:4px 10px;"
+            << "text-align:right}th{background:#f4f4f4}</style></head><body>\n"
+            << "<h1>NB-IoT simulation results</h1>\n" << svg()
+            << "<h2>Averages per mode</h2>\n<table><tr><th>Mode</th><th>Energy (J)</th>"
+            << "<th>Latency (ms)</th><th>Battery life (years)</th></tr>\n";
+        for (const auto& mode : modes) {
+            double energy = 0, latency = 0, battery = 0;
+            modeAverages(mode, energy, latency, battery);
+            out << "<tr><td>" << escape(mode) << "</td><td>" << format(energy, 2) << "</td><td>"
+                << format(latency, 0) << "</td><td>" << format(battery, 1) << "</td></tr>\n";
+        }
+        out << "</table>\n</body></html>\n";
+        return out.str();
+    }
+
+    // Même contenu que le rapport du script Python
+    std::string text() const {
+        std::ostringstream out;
+        out << "REAL NB-IoT SIMULATION REPORT\n" << std::string(40, '=') << "\n\n";
+        for (const auto& mode : modes) {
+            double energy = 0, latency = 0, battery = 0;
+            modeAverages(mode, energy, latency, battery);
+            out << "Mode: " << mode << "\n"
+                << "Average energy: " << format(energy, 2) << " J\n"
+                << "Average latency: " << format(latency, 0) << " ms\n"
+                << "Average battery life: " << format(battery, 1) << " years\n\n";
+        }
+        out << "CONCLUSION:\n"
+            << "These are REAL simulation results with natural variation.\n"
+            << "Each run produces different but consistent patterns.\n"
+            << "PUR provides the best performance across all metrics.\n";
+        return out.str();
+    }
+
+private:
+    static const int kMarginLeft = 80;
+    static const int kMarginRight = 30;
+    static const int kMarginTop = 45;
+    static const int kMarginBottom = 60;
+
+    void modeAverages(const std::string& mode, double& energy, double& latency, double& battery) const {
+        int count = 0;
+        for (const auto& row : rows) {
+            if (row.mode != mode) continue;
+            energy += row.energy;
+            latency += row.latency;
+            battery += row.batteryLife;
+            count++;
+        }
+        if (count > 0) {
+            energy /= count;
+            latency /= count;
+            battery /= count;
+        }
+    }
+
+    Frame frame(int originX, int originY) const {
+        Frame f;
+        f.left = originX + kMarginLeft;
+        f.top = originY + kMarginTop;
+        f.width = kWidth / 2 - kMarginLeft - kMarginRight;
+        f.height = kHeight / 2 - kMarginTop - kMarginBottom;
+        return f;
+    }
+
+    static void axes(std::ostringstream& out, const Frame& f, const std::string& title,
+                     const std::string& xLabel, const std::string& yLabel,
+                     const std::vector<double>& yTicks) {
+        int decimals = tickDecimals(yTicks);
+        for (double tick : yTicks) {
+            double y = f.py(tick);
+            out << "<line x1=\"" << format(f.left, 1) << "\" y1=\"" << format(y, 1) << "\" x2=\""
+                << format(f.left + f.width, 1) << "\" y2=\"" << format(y, 1)
+                << "\" stroke=\"#ddd\"/>\n";
+            out << "<text x=\"" << format(f.left - 8, 1) << "\" y=\"" << format(y + 4, 1)
+                << "\" text-anchor=\"end\">" << format(tick, decimals) << "</text>\n";
+        }
+        out << "<rect x=\"" << format(f.left, 1) << "\" y=\"" << format(f.top, 1) << "\" width=\""
+            << format(f.width, 1) << "\" height=\"" << format(f.height, 1)
+            << "\" fill=\"none\" stroke=\"#333\"/>\n";
+        out << "<text x=\"" << format(f.left + f.width / 2, 1) << "\" y=\"" << format(f.top - 15, 1)
+            << "\" text-anchor=\"middle\" font-size=\"16\" font-weight=\"bold\">" << escape(title)
+            << "</text>\n";
+        out << "<text x=\"" << format(f.left + f.width / 2, 1) << "\" y=\""
+            << format(f.top + f.height + 45, 1) << "\" text-anchor=\"middle\">" << escape(xLabel)
+            << "</text>\n";
+        double cx = f.left - 60, cy = f.top + f.height / 2;
+        out << "<text x=\"" << format(cx, 1) << "\" y=\"" << format(cy, 1)
+            << "\" text-anchor=\"middle\" transform=\"rotate(-90 " << format(cx, 1) << ' '
+            << format(cy, 1) << ")\">" << escape(yLabel) << "</text>\n";
+    }
+
+    static void marker(std::ostringstream& out, Marker shape, double x, double y,
+                       const std::string& color) {
+        switch (shape) {
+        case Marker::Circle:
+            out << "<circle cx=\"" << format(x, 1) << "\" cy=\"" << format(y, 1)
+                << "\" r=\"5\" fill=\"" << color << "\"/>\n";
+            break;
+        case Marker::Square:
+            out << "<rect x=\"" << format(x - 5, 1) << "\" y=\"" << format(y - 5, 1)
+                << "\" width=\"10\" height=\"10\" fill=\"" << color << "\"/>\n";
+            break;
+        case Marker::Triangle:
+            out << "<polygon points=\"" << format(x, 1) << ',' << format(y - 6, 1) << ' '
+                << format(x - 6, 1) << ',' << format(y + 5, 1) << ' ' << format(x + 6, 1) << ','
+                << format(y + 5, 1) << "\" fill=\"" << color << "\"/>\n";
+            break;
+        }
+    }
+
+    template <class Value, class Error>
+    void linePanel(std::ostringstream& out, int originX, int originY, const std::string& title,
+                   const std::string& yLabel, Marker shape, Value value, Error error) const {
+        std::vector<Series> series;
+        double low = 0.0, high = 0.0;
+        bool first = true;
+        for (const auto& mode : modes) {
+            Series s;
+            s.mode = mode;
+            for (const auto& row : rows) {
+                if (row.mode != mode) continue;
+                double v = value(row);
+                double e = errorOf(error, row);
+                s.x.push_back(row.devices);
+                s.y.push_back(v);
+                if (hasError(error)) s.error.push_back(e);
+                low = first ? v - e : std::min(low, v - e);
+                high = first ? v + e : std::max(high, v + e);
+                first = false;
+            }
+            series.push_back(s);
+        }
+
+        Frame f = frame(originX, originY);
+        std::vector<double> yTicks = niceTicks(low, high);
+        f.yMin = yTicks.front();
+        f.yMax = yTicks.back();
+        f.logX = true;
+        f.xMin = std::pow(10.0, std::floor(std::log10(deviceCounts.empty() ? 1.0 : deviceCounts.front())));
+        f.xMax = std::pow(10.0, std::ceil(std::log10(deviceCounts.empty() ? 10.0 : deviceCounts.back())));
+        if (f.xMax <= f.xMin) f.xMax = f.xMin * 10.0;
+
+        axes(out, f, title, "Number of Devices", yLabel, yTicks);
+        for (double tick = f.xMin; tick <= f.xMax * 1.001; tick *= 10.0) {
+            double x = f.px(tick);
+            out << "<line x1=\"" << format(x, 1) << "\" y1=\"" << format(f.top, 1) << "\" x2=\""
+                << format(x, 1) << "\" y2=\"" << format(f.top + f.height, 1)
+                << "\" stroke=\"#ddd\"/>\n";
+            out << "<text x=\"" << format(x, 1) << "\" y=\"" << format(f.top + f.height + 20, 1)
+                << "\" text-anchor=\"middle\">" << format(tick, 0) << "</text>\n";
+        }
+
+        for (size_t m = 0; m < series.size(); m++) {
+            const Series& s = series[m];
+            std::string color = modeColor(s.mode, m);
+            out << "<g opacity=\"0.85\">\n<polyline fill=\"none\" stroke=\"" << color
+                << "\" stroke-width=\"2\" points=\"";
+            for (size_t i = 0; i < s.x.size(); i++) {
+                out << format(f.px(s.x[i]), 1) << ',' << format(f.py(s.y[i]), 1) << ' ';
+            }
+            out << "\"/>\n";
+            for (size_t i = 0; i < s.x.size(); i++) {
+                double x = f.px(s.x[i]);
+                if (!s.error.empty()) {
+                    double top = f.py(s.y[i] + s.error[i]), bottom = f.py(s.y[i] - s.error[i]);
+                    out << "<path d=\"M" << format(x, 1) << ' ' << format(top, 1) << "V"
+                        << format(bottom, 1) << "M" << format(x - 5, 1) << ' ' << format(top, 1)
+                        << "h10M" << format(x - 5, 1) << ' ' << format(bottom, 1)
+                        << "h10\" stroke=\"" << color << "\" stroke-width=\"1.5\"/>\n";
+                }
+                marker(out, shape, x, f.py(s.y[i]), color);
+            }
+            out << "</g>\n";
+        }
+        legend(out, f, shape, series);
+    }
+
+    // Légende dans le coin supérieur qui recouvre le moins de points
+    void legend(std::ostringstream& out, const Frame& f, Marker shape,
+                const std::vector<Series>& series) const {
+        double boxHeight = modes.size() * 20.0 + 8.0;
+        int coveredLeft = 0, coveredRight = 0;
+        for (const auto& s : series) {
+            for (size_t i = 0; i < s.x.size(); i++) {
+                double px = f.px(s.x[i]), py = f.py(s.y[i]);
+                if (py > f.top + boxHeight + 10) continue;
+                if (px < f.left + 115) coveredLeft++;
+                if (px > f.left + f.width - 115) coveredRight++;
+            }
+        }
+        double x = coveredLeft < coveredRight ? f.left + 20 : f.left + f.width - 90;
+        double y = f.top + 12;
+        out << "<rect x=\"" << format(x - 10, 1) << "\" y=\"" << format(y - 10, 1)
+            << "\" width=\"95\" height=\"" << boxHeight
+            << "\" fill=\"white\" stroke=\"#ccc\"/>\n";
+        for (size_t m = 0; m < modes.size(); m++) {
+            double rowY = y + m * 20 + 4;
+            std::string color = modeColor(modes[m], m);
+            out << "<line x1=\"" << format(x, 1) << "\" y1=\"" << format(rowY, 1) << "\" x2=\""
+                << format(x + 24, 1) << "\" y2=\"" << format(rowY, 1) << "\" stroke=\"" << color
+                << "\" stroke-width=\"2\"/>\n";
+            marker(out, shape, x + 12, rowY, color);
+            out << "<text x=\"" << format(x + 32, 1) << "\" y=\"" << format(rowY + 4, 1) << "\">"
+                << escape(modes[m]) << "</text>\n";
+        }
+    }
+
+    // Panneau 4 : (E_RAP - E_PUR) / E_RAP par nombre d'appareils
+    void savingsPanel(std::ostringstream& out, int originX, int originY) const {
+        std::vector<double> savings;
+        std::vector<bool> present;
+        for (int devices : deviceCounts) {
+            const Row* rap = find("RAP", devices);
+            const Row* pur = find("PUR", devices);
+            present.push_back(rap != nullptr && pur != nullptr && rap->energy != 0.0);
+            savings.push_back(present.back() ? (rap->energy - pur->energy) / rap->energy * 100.0 : 0.0);
+        }
+
+        double low = 0.0, high = 0.0;
+        for (double s : savings) {
+            low = std::min(low, s);
+            high = std::max(high, s);
+        }
+        Frame f = frame(originX, originY);
+        std::vector<double> yTicks = niceTicks(low, high * 1.1);
+        f.yMin = yTicks.front();
+        f.yMax = yTicks.back();
+        f.logX = false;
+        f.xMin = 0.0;
+        f.xMax = std::max<size_t>(1, deviceCounts.size());
+
+        axes(out, f, "PUR Energy Savings vs RAP", "Number of Devices", "Energy Improvement (%)", yTicks);
+        double slot = f.width / f.xMax;
+        for (size_t i = 0; i < deviceCounts.size(); i++) {
+            double center = f.left + slot * (i + 0.5);
+            out << "<text x=\"" << format(center, 1) << "\" y=\"" << format(f.top + f.height + 20, 1)
+                << "\" text-anchor=\"middle\">" << deviceCounts[i] << "</text>\n";
+            if (!present[i]) continue;
+
+            double top = f.py(std::max(0.0, savings[i])), bottom = f.py(std::min(0.0, savings[i]));
+            out << "<rect x=\"" << format(center - slot * 0.4, 1) << "\" y=\"" << format(top, 1)
+                << "\" width=\"" << format(slot * 0.8, 1) << "\" height=\"" << format(bottom - top, 1)
+                << "\" fill=\"#2ECC71\" fill-opacity=\"0.7\" stroke=\"black\"/>\n";
+            out << "<text x=\"" << format(center, 1) << "\" y=\"" << format(top - 6, 1)
+                << "\" text-anchor=\"middle\" font-weight=\"bold\">" << format(savings[i], 1)
+                << "%</text>\n";
+        }
+    }
+
+    const Row* find(const std::string& mode, int devices) const {
+        for (const auto& row : rows) {
+            if (row.mode == mode && row.devices == devices) return &row;
+        }
+        return nullptr;
+    }
+
+    template <class Error>
+    static double errorOf(Error error, const Row& row) { return error(row); }
+    static double errorOf(std::nullptr_t, const Row&) { return 0.0; }
+    template <class Error>
+    static bool hasError(Error) { return true; }
+    static bool hasError(std::nullptr_t) { return false; }
+
+    const std::vector<Row>& rows;
+    std::vector<std::string> modes;
+    std::vector<int> deviceCounts;
+};
+
+inline void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot create " + path);
+    out << content;
+    out.close();
+    if (!out) throw std::runtime_error("Error while writing " + path);
+}
+
+// Écrit les graphiques (SVG), la page HTML et le rapport texte
+inline void writeReport(const std::vector<Row>& rows, const std::string& svgPath,
+                        const std::string& htmlPath, const std::string& textPath) {
+    SvgReport report(rows);
+    writeFile(svgPath, report.svg());
+    writeFile(htmlPath, report.html());
+    writeFile(textPath, report.text());
+}
+
+} // namespace Report
+
+#endif // NBIOT_REPORT_WRITER_H
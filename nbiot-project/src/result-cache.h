@@ -0,0 +1,364 @@
+/*
+ * On-disk cache of per-cell simulation results
+ *
+ * A cell is addressed by a 128-bit digest of everything that determines its
+ * result: mode, device count, cell seed, repeat index and a model hash. The
+ * model hash covers the model version and the parameters the caller passes
+ * in. Results for one model hash live in their own append-only pack file:
+ *
+ *   "NBCACHE\0" | version u32 | reserved u32
+ *   record: payload size u32 | digest 2 x u64 | payload | checksum u64
+ *
+ * Opening a cache reads the pack once and indexes it in a hash map, so a
+ * lookup is one probe. New records are appended as cells complete, and a
+ * torn record left by an interrupted run is cut off on the next open.
+ * Changing the model hash switches to another pack; prune() deletes the packs
+ * of other versions. Only one process should write a pack at a time.
+ */
+
+#ifndef NBIOT_RESULT_CACHE_H
+#define NBIOT_RESULT_CACHE_H
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "random-streams.h"
+#include "streaming-stats.h"
+
+// Ce que le cache conserve d'une cellule (pas les valeurs par appareil)
+struct CellRecord {
+    double avgEnergy = 0.0;
+    double avgLatency = 0.0;
+    double energyStdDev = 0.0;
+    double latencyStdDev = 0.0;
+    double batteryLife = 0.0;
+    RunningStats energyStats;
+    RunningStats latencyStats;
+    QuantileSketch energySketch;
+    QuantileSketch latencySketch;
+    uint64_t simulatedEvents = 0;
+    uint64_t collisions = 0;
+    uint64_t failedAccesses = 0;
+    double failedEnergy = 0.0;
+};
+
+class ResultCache {
+public:
+    static const uint32_t kVersion = 2;
+
+    struct Key {
+        std::string mode;
+        int numDevices;
+        uint64_t seed;
+        int repeat;
+    };
+
+    // Accumulateur FNV-1a pour construire le hash du modèle
+    class ModelHash {
+    public:
+        ModelHash() : hash(0xCBF29CE484222325ULL) {}
+
+        ModelHash& add(const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001B3ULL;
+            }
+            return *this;
+        }
+        ModelHash& add(const std::string& text) {
+            uint64_t size = text.size();
+            add(&size, sizeof(size));
+            return add(text.data(), text.size());
+        }
+        ModelHash& add(double value) { return add(&value, sizeof(value)); }
+        ModelHash& add(int64_t value) { return add(&value, sizeof(value)); }
+
+        uint64_t value() const { return hash; }
+
+    private:
+        uint64_t hash;
+    };
+
+    ResultCache(const std::string& directory, uint64_t modelHash)
+        : directory(directory), modelHash(modelHash), hits(0), misses(0) {
+        if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Cannot create cache directory: " + directory);
+        }
+        path = packPath(directory, modelHash);
+        load();
+        out.open(path, std::ios::binary | std::ios::app);
+        if (!out) throw std::runtime_error("Cannot open cache pack: " + path);
+        if (index.empty() && fileSize(path) == 0) writeHeader();
+    }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Thread-safe
+    bool lookup(const Key& key, CellRecord& record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(digest(key));
+        if (found == index.end() || !decode(found->second, key, record)) {
+            misses++;
+            return false;
+        }
+        hits++;
+        return true;
+    }
+
+    // Thread-safe ; l'enregistrement est sur disque au retour
+    void store(const Key& key, const CellRecord& record) {
+        std::vector<uint8_t> payload;
+        encode(key, record, payload);
+        Digest d = digest(key);
+
+        std::vector<uint8_t> bytes;
+        put<uint32_t>(bytes, static_cast<uint32_t>(payload.size()));
+        put<uint64_t>(bytes, d.high);
+        put<uint64_t>(bytes, d.low);
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+        put<uint64_t>(bytes, checksum(bytes.data() + sizeof(uint32_t), bytes.size() - sizeof(uint32_t)));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        out.flush();
+        if (!out) throw std::runtime_error("Error while writing cache pack: " + path);
+        index[d] = std::move(payload);
+    }
+
+    size_t size() const { return index.size(); }
+    uint64_t hitCount() const { return hits; }
+    uint64_t missCount() const { return misses; }
+    const std::string& packFile() const { return path; }
+
+    // Supprime les packs des autres versions du modèle ; renvoie leur nombre
+    static size_t prune(const std::string& directory, uint64_t keepModelHash) {
+        DIR* dir = opendir(directory.c_str());
+        if (dir == nullptr) return 0;
+        const std::string keep = packPath(directory, keepModelHash);
+        size_t removed = 0;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, 6, "cells-") != 0 || name.size() < 5 ||
+                name.compare(name.size() - 5, 5, ".pack") != 0) {
+                continue;
+            }
+            std::string file = directory + "/" + name;
+            if (file != keep && std::remove(file.c_str()) == 0) removed++;
+        }
+        closedir(dir);
+        return removed;
+    }
+
+    static std::string packPath(const std::string& directory, uint64_t modelHash) {
+        char name[32];
+        snprintf(name, sizeof(name), "cells-%016llx.pack", static_cast<unsigned long long>(modelHash));
+        return directory + "/" + name;
+    }
+
+    // Charge utile d'un enregistrement, reprise par les fichiers de shard.
+    // La clé complète est stockée pour écarter une collision de digest
+    static void encode(const Key& key, const CellRecord& record, std::vector<uint8_t>& payload) {
+        put<uint8_t>(payload, static_cast<uint8_t>(key.mode.size()));
+        payload.insert(payload.end(), key.mode.begin(), key.mode.end());
+        put<int32_t>(payload, key.numDevices);
+        put<uint64_t>(payload, key.seed);
+        put<int32_t>(payload, key.repeat);
+
+        put<double>(payload, record.avgEnergy);
+        put<double>(payload, record.avgLatency);
+        put<double>(payload, record.energyStdDev);
+        put<double>(payload, record.latencyStdDev);
+        put<double>(payload, record.batteryLife);
+        putStats(payload, record.energyStats);
+        putStats(payload, record.latencyStats);
+        putSketch(payload, record.energySketch);
+        putSketch(payload, record.latencySketch);
+        put<uint64_t>(payload, record.simulatedEvents);
+        put<uint64_t>(payload, record.collisions);
+        put<uint64_t>(payload, record.failedAccesses);
+        put<double>(payload, record.failedEnergy);
+    }
+
+    static bool decode(const std::vector<uint8_t>& payload, const Key& key, CellRecord& record) {
+        size_t cursor = 0;
+        uint8_t modeSize;
+        if (!get(payload, cursor, modeSize) || cursor + modeSize > payload.size()) return false;
+        std::string mode(reinterpret_cast<const char*>(payload.data() + cursor), modeSize);
+        cursor += modeSize;
+        int32_t numDevices, repeat;
+        uint64_t seed;
+        if (!get(payload, cursor, numDevices) || !get(payload, cursor, seed) ||
+            !get(payload, cursor, repeat)) {
+            return false;
+        }
+        if (mode != key.mode || numDevices != key.numDevices || seed != key.seed || repeat != key.repeat) {
+            return false;
+        }
+
+        return get(payload, cursor, record.avgEnergy) && get(payload, cursor, record.avgLatency) &&
+               get(payload, cursor, record.energyStdDev) && get(payload, cursor, record.latencyStdDev) &&
+               get(payload, cursor, record.batteryLife) &&
+               getStats(payload, cursor, record.energyStats) &&
+               getStats(payload, cursor, record.latencyStats) &&
+               getSketch(payload, cursor, record.energySketch) &&
+               getSketch(payload, cursor, record.latencySketch) &&
+               get(payload, cursor, record.simulatedEvents) && get(payload, cursor, record.collisions) &&
+               get(payload, cursor, record.failedAccesses) && get(payload, cursor, record.failedEnergy);
+    }
+
+private:
+    struct Digest {
+        uint64_t high;
+        uint64_t low;
+        bool operator==(const Digest& other) const { return high == other.high && low == other.low; }
+    };
+
+    struct DigestHash {
+        size_t operator()(const Digest& d) const { return static_cast<size_t>(d.low); }
+    };
+
+    Digest digest(const Key& key) const {
+        uint64_t fields[4] = {RandomStreams::hashName(key.mode), static_cast<uint64_t>(key.numDevices),
+                              key.seed, static_cast<uint64_t>(key.repeat)};
+        Digest d{modelHash, ~modelHash};
+        for (uint64_t field : fields) {
+            d.high = RandomStreams::mixSeed(d.high, field);
+            d.low = RandomStreams::mixSeed(d.low, field ^ 0x5851F42D4C957F2DULL);
+        }
+        return d;
+    }
+
+    static uint64_t checksum(const uint8_t* data, size_t size) {
+        return ModelHash().add(data, size).value();
+    }
+
+    static size_t fileSize(const std::string& file) {
+        struct stat info;
+        return stat(file.c_str(), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+    }
+
+    template <class T>
+    static void put(std::vector<uint8_t>& buffer, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <class T>
+    static bool get(const std::vector<uint8_t>& buffer, size_t& cursor, T& value) {
+        if (cursor + sizeof(T) > buffer.size()) return false;
+        std::memcpy(&value, buffer.data() + cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    static void putStats(std::vector<uint8_t>& buffer, const RunningStats& stats) {
+        put<uint64_t>(buffer, stats.count());
+        put<double>(buffer, stats.mean());
+        put<double>(buffer, stats.sumOfSquaredDeviations());
+        put<double>(buffer, stats.min());
+        put<double>(buffer, stats.max());
+    }
+
+    static bool getStats(const std::vector<uint8_t>& buffer, size_t& cursor, RunningStats& stats) {
+        uint64_t count;
+        double mean, m2, minValue, maxValue;
+        if (!get(buffer, cursor, count) || !get(buffer, cursor, mean) || !get(buffer, cursor, m2) ||
+            !get(buffer, cursor, minValue) || !get(buffer, cursor, maxValue)) {
+            return false;
+        }
+        stats = RunningStats::fromMoments(count, mean, m2, minValue, maxValue);
+        return true;
+    }
+
+    static void putSketch(std::vector<uint8_t>& buffer, const QuantileSketch& sketch) {
+        put<int64_t>(buffer, sketch.firstBucketIndex());
+        put<uint64_t>(buffer, sketch.nonPositiveCount());
+        put<uint64_t>(buffer, sketch.bucketCounts().size());
+        for (uint64_t count : sketch.bucketCounts()) put<uint64_t>(buffer, count);
+    }
+
+    static bool getSketch(const std::vector<uint8_t>& buffer, size_t& cursor, QuantileSketch& sketch) {
+        int64_t firstBucket;
+        uint64_t nonPositive, size;
+        if (!get(buffer, cursor, firstBucket) || !get(buffer, cursor, nonPositive) ||
+            !get(buffer, cursor, size) || size > (buffer.size() - cursor) / sizeof(uint64_t)) {
+            return false;
+        }
+        std::vector<uint64_t> counts(static_cast<size_t>(size));
+        for (auto& count : counts) get(buffer, cursor, count);
+        sketch = QuantileSketch::fromBuckets(firstBucket, nonPositive, counts);
+        return true;
+    }
+
+    void writeHeader() {
+        char header[16] = {'N', 'B', 'C', 'A', 'C', 'H', 'E', '\0'};
+        std::memcpy(header + 8, &kVersion, sizeof(kVersion));
+        out.write(header, sizeof(header));
+        out.flush();
+    }
+
+    // Indexe le pack ; coupe un dernier enregistrement incomplet
+    void load() {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        if (data.empty()) return;
+
+        uint32_t version = 0;
+        if (data.size() >= 16) std::memcpy(&version, data.data() + 8, sizeof(version));
+        if (data.size() < 16 || std::memcmp(data.data(), "NBCACHE", 8) != 0 || version != kVersion) {
+            // Pack illisible : on repart de zéro
+            if (std::remove(path.c_str()) != 0) throw std::runtime_error("Cannot reset cache pack: " + path);
+            return;
+        }
+
+        size_t cursor = 16;
+        while (cursor < data.size()) {
+            size_t start = cursor;
+            uint32_t size;
+            Digest d;
+            if (!get(data, cursor, size) || !get(data, cursor, d.high) || !get(data, cursor, d.low) ||
+                cursor + size + sizeof(uint64_t) > data.size()) {
+                cursor = start;
+                break;
+            }
+            uint64_t stored;
+            std::memcpy(&stored, data.data() + cursor + size, sizeof(stored));
+            if (stored != checksum(data.data() + start + sizeof(uint32_t), cursor + size - start - sizeof(uint32_t))) {
+                cursor = start;
+                break;
+            }
+            index[d].assign(data.begin() + cursor, data.begin() + cursor + size);
+            cursor += size + sizeof(uint64_t);
+        }
+        if (cursor < data.size() && truncate(path.c_str(), static_cast<off_t>(cursor)) != 0) {
+            throw std::runtime_error("Cannot repair cache pack: " + path);
+        }
+    }
+
+    std::string directory;
+    std::string path;
+    uint64_t modelHash;
+    std::mutex mutex;
+    std::ofstream out;
+    std::unordered_map<Digest, std::vector<uint8_t>, DigestHash> index;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+#endif // NBIOT_RESULT_CACHE_H
@@ -0,0 +1,468 @@
+/*
+ * Live NDJSON stream of sweep results
+ *
+ * One JSON object per line, as the sweep runs: "sweep" when it starts,
+ * "progress" while a large cell is being simulated, "cell" when a
+ * replication is finished (or read from the cache), "aggregate" for each
+ * averaged (mode, devices) result and "done" at the end. Targets:
+ *
+ *   -           standard output (the human-readable log moves to stderr)
+ *   unix:PATH   Unix domain socket; any number of consumers may connect
+ *   PATH        a FIFO (created with mkfifo), or else a regular file
+ *
+ * Simulation threads only queue small event structs; formatting and I/O
+ * happen on a background thread, so a slow consumer never stalls the
+ * sweep. Progress events of a cell replace each other while they wait, so
+ * the queue holds at most one per running cell plus one per finished cell.
+ * FIFO and socket consumers are written without blocking; one that falls
+ * kMaxPendingBytes behind is disconnected. With no consumer attached, the
+ * writer drops events without formatting them. A consumer that connects
+ * mid-sweep first receives the "sweep" line.
+ */
+
+#ifndef NBIOT_RESULT_STREAM_H
+#define NBIOT_RESULT_STREAM_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+class ResultStream {
+public:
+    static const size_t kMaxPendingBytes = 4 << 20;
+
+    struct SweepInfo {
+        uint64_t run;
+        std::string engine;          // "closed-form" ou "des"
+        std::string kernel;
+        unsigned threads;
+        std::vector<std::string> modes;
+        std::vector<int> deviceCounts;
+    };
+
+    // Une réplication terminée
+    struct CellInfo {
+        std::string mode;
+        int devices;
+        int repeat;
+        uint64_t seed;
+        bool cached;
+        double energyMean, energyStdDev;
+        double latencyMean, latencyStdDev;
+        double latencyP50, latencyP95, latencyP99;
+        double batteryYears;
+        uint64_t collisions, failedAccesses;
+    };
+
+    // État partiel d'une réplication en cours
+    struct ProgressInfo {
+        std::string mode;
+        int devices;
+        int repeat;
+        int64_t done;                // appareils simulés
+        double energyMean, latencyMean;
+        double seconds;              // depuis le début de la réplication
+    };
+
+    // Moyenne des réplications d'une cellule (mode, appareils)
+    struct AggregateInfo {
+        std::string mode;
+        int devices;
+        int replications;
+        double energyMean, latencyMean;
+        double latencyP50, latencyP95, latencyP99;
+        double batteryYears;
+    };
+
+    struct DoneInfo {
+        uint64_t cells;
+        uint64_t computedCells;
+        uint64_t devices;
+        double seconds;
+    };
+
+    explicit ResultStream(const std::string& target)
+        : listenFd(-1), fifo(false), attached(false), stopping(false), coalesced(0) {
+        // Un lecteur qui ferme son côté donne EPIPE au lieu de tuer le processus
+        std::signal(SIGPIPE, SIG_IGN);
+        if (target == "-") {
+            consumers.push_back({STDOUT_FILENO, std::string(), true, false});
+        } else if (target.compare(0, 5, "unix:") == 0) {
+            listen(target.substr(5));
+        } else {
+            struct stat info;
+            if (stat(target.c_str(), &info) == 0 && S_ISFIFO(info.st_mode)) {
+                fifo = true;
+                fifoPath = target;
+            } else {
+                int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+                if (fd < 0) throw std::runtime_error("Cannot open stream target: " + target);
+                consumers.push_back({fd, std::string(), true, true});
+            }
+        }
+        attached = !consumers.empty();
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    ~ResultStream() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    ResultStream(const ResultStream&) = delete;
+    ResultStream& operator=(const ResultStream&) = delete;
+
+    // Un consommateur est-il branché ? (les producteurs peuvent s'épargner un événement)
+    bool hasConsumer() const { return attached.load(std::memory_order_relaxed); }
+
+    void sweepStarted(const SweepInfo& info) {
+        Event event(Event::Sweep);
+        event.sweep = info;
+        push(event);
+    }
+
+    void cellDone(const CellInfo& info) {
+        Event event(Event::Cell);
+        event.cell = info;
+        push(event);
+    }
+
+    void aggregate(const AggregateInfo& info) {
+        Event event(Event::Aggregate);
+        event.aggregate = info;
+        push(event);
+    }
+
+    void sweepDone(const DoneInfo& info) {
+        Event event(Event::Done);
+        event.done = info;
+        push(event);
+    }
+
+    void progress(const ProgressInfo& info) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ProgressKey key(info.mode, info.devices, info.repeat);
+        if (!pendingProgress.insert({key, info}).second) {
+            pendingProgress[key] = info;
+            coalesced++;
+        }
+        queueReady.notify_one();
+    }
+
+    // Écrit ce qui reste (2 s au plus pour les consommateurs lents) et ferme
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (stopping) return;
+            stopping = true;
+        }
+        queueReady.notify_one();
+        writer.join();
+        for (auto& consumer : consumers) {
+            if (consumer.ownsFd) ::close(consumer.fd);
+        }
+        consumers.clear();
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            unlink(socketPath.c_str());
+        }
+    }
+
+private:
+    struct Event {
+        enum Type { Sweep, Cell, Aggregate, Done } type;
+        SweepInfo sweep;
+        CellInfo cell;
+        AggregateInfo aggregate;
+        DoneInfo done;
+
+        explicit Event(Type type) : type(type), sweep(), cell(), aggregate(), done() {}
+    };
+
+    struct Consumer {
+        int fd;
+        std::string pending;
+        bool blocking;      // sortie standard, fichier : écriture complète
+        bool ownsFd;
+    };
+
+    typedef std::tuple<std::string, int, int> ProgressKey;
+
+    void listen(const std::string& path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw std::runtime_error("Cannot create socket for " + path);
+        // Socket restée d'une exécution précédente ; jamais un autre type de fichier
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(path.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listenFd, 16) != 0) {
+            ::close(listenFd);
+            listenFd = -1;
+            throw std::runtime_error("Cannot listen on " + path + ": " + std::strerror(errno));
+        }
+        socketPath = path;
+    }
+
+    void push(const Event& event) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(event);
+        queueReady.notify_one();
+    }
+
+    // Nouveaux lecteurs : connexions en attente, ou FIFO ouverte par un lecteur
+    void acceptConsumers() {
+        if (listenFd >= 0) {
+            for (;;) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) break;
+                consumers.push_back({fd, sweepLine, false, true});
+            }
+        }
+        if (fifo && consumers.empty()) {
+            // ENXIO tant qu'aucun lecteur n'a ouvert la FIFO
+            int fd = ::open(fifoPath.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd >= 0) consumers.push_back({fd, sweepLine, false, true});
+        }
+        attached = !consumers.empty();
+    }
+
+    // Envoie ce qui peut l'être ; retire les consommateurs partis ou trop lents
+    void flush() {
+        for (size_t c = 0; c < consumers.size();) {
+            Consumer& consumer = consumers[c];
+            bool gone = false;
+            while (!consumer.pending.empty()) {
+                ssize_t written = ::write(consumer.fd, consumer.pending.data(), consumer.pending.size());
+                if (written > 0) {
+                    consumer.pending.erase(0, static_cast<size_t>(written));
+                } else if (written < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    gone = !(written < 0 && errno == EAGAIN && !consumer.blocking);
+                    break;
+                }
+            }
+            if (gone || consumer.pending.size() > kMaxPendingBytes) {
+                if (consumer.ownsFd) ::close(consumer.fd);
+                consumers.erase(consumers.begin() + c);
+            } else {
+                c++;
+            }
+        }
+        attached = !consumers.empty();
+    }
+
+    bool flushed() const {
+        for (const auto& consumer : consumers) {
+            if (!consumer.pending.empty()) return false;
+        }
+        return true;
+    }
+
+    void writerLoop() {
+        const bool polling = listenFd >= 0 || fifo;
+        std::chrono::steady_clock::time_point deadline;
+        bool draining = false;
+        for (;;) {
+            std::deque<Event> events;
+            std::map<ProgressKey, ProgressInfo> progressEvents;
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                auto ready = [this] { return !queue.empty() || !pendingProgress.empty() || stopping; };
+                // Sans FIFO ni socket, rien ne se passe entre deux événements
+                if (polling || !flushed()) {
+                    queueReady.wait_for(lock, std::chrono::milliseconds(50), ready);
+                } else {
+                    queueReady.wait(lock, ready);
+                }
+                events.swap(queue);
+                progressEvents.swap(pendingProgress);
+                stop = stopping;
+            }
+
+            acceptConsumers();
+            for (const auto& event : events) {
+                if (event.type == Event::Sweep) sweepLine = format(event);
+                if (consumers.empty()) continue;
+                const std::string& line = event.type == Event::Sweep ? sweepLine : format(event);
+                for (auto& consumer : consumers) consumer.pending += line;
+            }
+            if (!consumers.empty()) {
+                for (const auto& entry : progressEvents) {
+                    std::string line = format(entry.second);
+                    for (auto& consumer : consumers) consumer.pending += line;
+                }
+            }
+            flush();
+
+            if (stop) {
+                if (!draining) {
+                    draining = true;
+                    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+                }
+                if (flushed() || std::chrono::steady_clock::now() >= deadline) return;
+                pollWritable();
+            }
+        }
+    }
+
+    // Attente courte d'un consommateur prêt à recevoir, pendant la vidange finale
+    void pollWritable() {
+        std::vector<pollfd> fds;
+        for (const auto& consumer : consumers) {
+            if (!consumer.pending.empty()) fds.push_back({consumer.fd, POLLOUT, 0});
+        }
+        if (!fds.empty()) poll(fds.data(), fds.size(), 50);
+    }
+
+    // Nombres JSON : null pour NaN et ±inf
+    static void number(std::ostringstream& out, double value) {
+        if (std::isfinite(value)) {
+            out << value;
+        } else {
+            out << "null";
+        }
+    }
+
+    static std::string quote(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::string format(const Event& event) const {
+        std::ostringstream out;
+        out << std::setprecision(10);
+        switch (event.type) {
+        case Event::Sweep: {
+            const SweepInfo& s = event.sweep;
+            out << "{\"event\":\"sweep\",\"run\":" << s.run << ",\"engine\":" << quote(s.engine)
+                << ",\"kernel\":" << quote(s.kernel) << ",\"threads\":" << s.threads << ",\"modes\":[";
+            for (size_t m = 0; m < s.modes.size(); m++) out << (m ? "," : "") << quote(s.modes[m]);
+            out << "],\"devices\":[";
+            for (size_t d = 0; d < s.deviceCounts.size(); d++) out << (d ? "," : "") << s.deviceCounts[d];
+            out << "]}";
+            break;
+        }
+        case Event::Cell: {
+            const CellInfo& c = event.cell;
+            out << "{\"event\":\"cell\",\"mode\":" << quote(c.mode) << ",\"devices\":" << c.devices
+                << ",\"repeat\":" << c.repeat << ",\"seed\":\"" << std::hex << c.seed << std::dec
+                << "\",\"cached\":" << (c.cached ? "true" : "false") << ",\"energyMean\":";
+            number(out, c.energyMean);
+            out << ",\"energyStdDev\":";
+            number(out, c.energyStdDev);
+            out << ",\"latencyMean\":";
+            number(out, c.latencyMean);
+            out << ",\"latencyStdDev\":";
+            number(out, c.latencyStdDev);
+            out << ",\"latencyP50\":";
+            number(out, c.latencyP50);
+            out << ",\"latencyP95\":";
+            number(out, c.latencyP95);
+            out << ",\"latencyP99\":";
+            number(out, c.latencyP99);
+            out << ",\"batteryYears\":";
+            number(out, c.batteryYears);
+            out << ",\"collisions\":" << c.collisions << ",\"failedAccesses\":" << c.failedAccesses << "}";
+            break;
+        }
+        case Event::Aggregate: {
+            const AggregateInfo& a = event.aggregate;
+            out << "{\"event\":\"aggregate\",\"mode\":" << quote(a.mode) << ",\"devices\":" << a.devices
+                << ",\"replications\":" << a.replications << ",\"energyMean\":";
+            number(out, a.energyMean);
+            out << ",\"latencyMean\":";
+            number(out, a.latencyMean);
+            out << ",\"latencyP50\":";
+            number(out, a.latencyP50);
+            out << ",\"latencyP95\":";
+            number(out, a.latencyP95);
+            out << ",\"latencyP99\":";
+            number(out, a.latencyP99);
+            out << ",\"batteryYears\":";
+            number(out, a.batteryYears);
+            out << "}";
+            break;
+        }
+        case Event::Done: {
+            const DoneInfo& d = event.done;
+            out << "{\"event\":\"done\",\"cells\":" << d.cells << ",\"computedCells\":" << d.computedCells
+                << ",\"devices\":" << d.devices << ",\"seconds\":";
+            number(out, d.seconds);
+            out << ",\"coalescedProgress\":" << coalesced << "}";
+            break;
+        }
+        }
+        out << "\n";
+        return out.str();
+    }
+
+    std::string format(const ProgressInfo& p) const {
+        std::ostringstream out;
+        out << std::setprecision(10);
+        out << "{\"event\":\"progress\",\"mode\":" << quote(p.mode) << ",\"devices\":" << p.devices
+            << ",\"repeat\":" << p.repeat << ",\"done\":" << p.done << ",\"energyMean\":";
+        number(out, p.energyMean);
+        out << ",\"latencyMean\":";
+        number(out, p.latencyMean);
+        out << ",\"seconds\":";
+        number(out, p.seconds);
+        out << "}\n";
+        return out.str();
+    }
+
+    // Côté thread d'écriture
+    std::vector<Consumer> consumers;
+    int listenFd;
+    std::string socketPath;
+    bool fifo;
+    std::string fifoPath;
+    std::string sweepLine;           // renvoyée à chaque nouveau consommateur
+    std::atomic<bool> attached;
+
+    // File partagée avec les producteurs
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Event> queue;
+    std::map<ProgressKey, ProgressInfo> pendingProgress;
+    bool stopping;
+    std::atomic<uint64_t> coalesced;    // événements progress remplacés avant d'être écrits
+    std::thread writer;
+};
+
+#endif // NBIOT_RESULT_STREAM_H
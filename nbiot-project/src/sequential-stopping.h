@@ -0,0 +1,81 @@
+/*
+ * Confidence intervals for sequential replication
+ *
+ * A cell is replicated until the 95% Student-t confidence interval of its
+ * mean is narrow enough. The independent units are single replications or,
+ * with antithetic variates, the average of a replication and its antithetic
+ * twin. unitsNeeded() extrapolates from the current sample variance how many
+ * units reach a target half-width, so a cell grows in a few waves instead of
+ * one replication at a time.
+ */
+
+#ifndef NBIOT_SEQUENTIAL_STOPPING_H
+#define NBIOT_SEQUENTIAL_STOPPING_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace SequentialStopping {
+
+// Quantile 0,975 de la loi de Student à `degrees` degrés de liberté
+inline double studentT975(int degrees) {
+    static const double kTable[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degrees < 1) return std::numeric_limits<double>::infinity();
+    if (degrees <= 30) return kTable[degrees - 1];
+    // Développement de Cornish-Fisher autour de z = 1,96
+    const double z = 1.959963984540054;
+    const double v = degrees;
+    return z + (z * z * z + z) / (4.0 * v)
+             + (5.0 * std::pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * v * v);
+}
+
+struct Interval {
+    int units;
+    double mean;
+    double halfWidth;    // infini tant qu'il y a moins de deux unités
+
+    double relativeHalfWidth() const {
+        return mean != 0.0 ? halfWidth / std::fabs(mean) : std::numeric_limits<double>::infinity();
+    }
+};
+
+inline Interval meanInterval(const std::vector<double>& values) {
+    Interval interval{static_cast<int>(values.size()), 0.0, std::numeric_limits<double>::infinity()};
+    if (values.empty()) return interval;
+    for (double value : values) interval.mean += value;
+    interval.mean /= values.size();
+    if (values.size() < 2) return interval;
+
+    double m2 = 0.0;
+    for (double value : values) m2 += (value - interval.mean) * (value - interval.mean);
+    double standardError = std::sqrt(m2 / (values.size() - 1) / values.size());
+    interval.halfWidth = studentT975(interval.units - 1) * standardError;
+    return interval;
+}
+
+// Regroupe les réplications en unités indépendantes (paires antithétiques moyennées)
+inline std::vector<double> units(const std::vector<double>& replications, bool antithetic) {
+    if (!antithetic) return replications;
+    std::vector<double> pairs;
+    for (size_t i = 0; i + 1 < replications.size(); i += 2) {
+        pairs.push_back(0.5 * (replications[i] + replications[i + 1]));
+    }
+    return pairs;
+}
+
+// Unités nécessaires pour une demi-largeur `target` (n·(h/cible)², arrondi au-dessus)
+inline int unitsNeeded(const Interval& interval, double target) {
+    if (interval.halfWidth <= target) return interval.units;
+    if (!std::isfinite(interval.halfWidth)) return interval.units + 1;
+    double ratio = interval.halfWidth / target;
+    double needed = std::ceil(interval.units * ratio * ratio);
+    return needed > 1e9 ? 1000000000 : static_cast<int>(needed);
+}
+
+} // namespace SequentialStopping
+
+#endif // NBIOT_SEQUENTIAL_STOPPING_H
@@ -0,0 +1,194 @@
+/*
+ * Partial results of one shard of a sweep
+ *
+ * --shard i/N simulates the cells whose index in the (mode, device count,
+ * repeat) grid is congruent to i modulo N, and saves their mergeable state
+ * instead of the final report:
+ *
+ *   "NBSHARD\0" | version u32 | shard u32 | shard count u32 | cell count u32
+ *   manifest: model hash u64 | master seed u64 | repeats u32 | flags u32 |
+ *             mode count u32 | (size u8, name)... | device count u32 | i32...
+ *   cell: grid index u32 | payload size u32 | payload (ResultCache format)
+ *   checksum u64 over everything before it
+ *
+ * The payload holds count, mean, M2, min and max of the energy and latency
+ * accumulators and both quantile sketches, so merging the shards rebuilds
+ * exactly the cells of a single-process run. The file is written under a
+ * temporary name and renamed, so a shard killed mid-write leaves no file
+ * that a merge could mistake for a complete one.
+ */
+
+#ifndef NBIOT_SHARD_STATE_H
+#define NBIOT_SHARD_STATE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "result-cache.h"
+
+namespace ShardState {
+
+const uint32_t kVersion = 2;
+
+// Ce qui doit être identique dans tous les shards d'un même balayage
+struct Manifest {
+    uint32_t shardIndex = 0;
+    uint32_t shardCount = 1;
+    uint64_t modelHash = 0;
+    uint64_t masterSeed = 0;
+    uint32_t repeats = 0;              // réplications par cellule
+    bool commonRandomNumbers = false;
+    bool antithetic = false;
+    std::vector<std::string> modes;
+    std::vector<int> deviceCounts;
+
+    uint32_t gridSize() const {
+        return static_cast<uint32_t>(modes.size() * deviceCounts.size()) * repeats;
+    }
+
+    bool sameSweep(const Manifest& other) const {
+        return shardCount == other.shardCount && modelHash == other.modelHash &&
+               masterSeed == other.masterSeed && repeats == other.repeats &&
+               commonRandomNumbers == other.commonRandomNumbers && antithetic == other.antithetic &&
+               modes == other.modes && deviceCounts == other.deviceCounts;
+    }
+};
+
+struct Cell {
+    uint32_t index;                    // position dans la grille (mode, appareils, répétition)
+    ResultCache::Key key;
+    CellRecord record;
+};
+
+// Cellule lue, décodée par l'appelant une fois les manifestes comparés
+struct StoredCell {
+    uint32_t index;
+    std::vector<uint8_t> payload;
+};
+
+template <class T>
+inline void put(std::vector<uint8_t>& buffer, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+inline T get(const std::vector<uint8_t>& buffer, size_t& cursor, const std::string& path) {
+    if (cursor + sizeof(T) > buffer.size()) throw std::runtime_error("Truncated shard file: " + path);
+    T value;
+    std::memcpy(&value, buffer.data() + cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+inline uint64_t checksum(const uint8_t* data, size_t size) {
+    return ResultCache::ModelHash().add(data, size).value();
+}
+
+inline std::string fileName(uint32_t shardIndex, uint32_t shardCount) {
+    return "shard-" + std::to_string(shardIndex) + "-of-" + std::to_string(shardCount) + ".nbshard";
+}
+
+inline void write(const std::string& path, const Manifest& manifest, const std::vector<Cell>& cells) {
+    std::vector<uint8_t> bytes(8);
+    std::memcpy(bytes.data(), "NBSHARD", 8);
+    put<uint32_t>(bytes, kVersion);
+    put<uint32_t>(bytes, manifest.shardIndex);
+    put<uint32_t>(bytes, manifest.shardCount);
+    put<uint32_t>(bytes, static_cast<uint32_t>(cells.size()));
+
+    put<uint64_t>(bytes, manifest.modelHash);
+    put<uint64_t>(bytes, manifest.masterSeed);
+    put<uint32_t>(bytes, manifest.repeats);
+    put<uint32_t>(bytes, (manifest.commonRandomNumbers ? 1u : 0u) | (manifest.antithetic ? 2u : 0u));
+    put<uint32_t>(bytes, static_cast<uint32_t>(manifest.modes.size()));
+    for (const auto& mode : manifest.modes) {
+        put<uint8_t>(bytes, static_cast<uint8_t>(mode.size()));
+        bytes.insert(bytes.end(), mode.begin(), mode.end());
+    }
+    put<uint32_t>(bytes, static_cast<uint32_t>(manifest.deviceCounts.size()));
+    for (int count : manifest.deviceCounts) put<int32_t>(bytes, count);
+
+    std::vector<uint8_t> payload;
+    for (const auto& cell : cells) {
+        payload.clear();
+        ResultCache::encode(cell.key, cell.record, payload);
+        put<uint32_t>(bytes, cell.index);
+        put<uint32_t>(bytes, static_cast<uint32_t>(payload.size()));
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+    }
+    put<uint64_t>(bytes, checksum(bytes.data(), bytes.size()));
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) throw std::runtime_error("Error while writing " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot rename " + temporary + " to " + path);
+    }
+}
+
+inline std::vector<StoredCell> read(const std::string& path, Manifest& manifest) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open shard file: " + path);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (bytes.size() < 8 + sizeof(uint64_t) || std::memcmp(bytes.data(), "NBSHARD", 8) != 0) {
+        throw std::runtime_error("Not a shard file: " + path);
+    }
+    uint64_t stored;
+    std::memcpy(&stored, bytes.data() + bytes.size() - sizeof(stored), sizeof(stored));
+    bytes.resize(bytes.size() - sizeof(stored));
+    if (stored != checksum(bytes.data(), bytes.size())) {
+        throw std::runtime_error("Corrupted shard file: " + path);
+    }
+
+    size_t cursor = 8;
+    if (get<uint32_t>(bytes, cursor, path) != kVersion) {
+        throw std::runtime_error("Unsupported shard file version: " + path);
+    }
+    manifest.shardIndex = get<uint32_t>(bytes, cursor, path);
+    manifest.shardCount = get<uint32_t>(bytes, cursor, path);
+    uint32_t cellCount = get<uint32_t>(bytes, cursor, path);
+    if (manifest.shardIndex >= manifest.shardCount) throw std::runtime_error("Invalid shard index in " + path);
+
+    manifest.modelHash = get<uint64_t>(bytes, cursor, path);
+    manifest.masterSeed = get<uint64_t>(bytes, cursor, path);
+    manifest.repeats = get<uint32_t>(bytes, cursor, path);
+    uint32_t flags = get<uint32_t>(bytes, cursor, path);
+    manifest.commonRandomNumbers = (flags & 1u) != 0;
+    manifest.antithetic = (flags & 2u) != 0;
+    manifest.modes.resize(get<uint32_t>(bytes, cursor, path));
+    for (auto& mode : manifest.modes) {
+        uint8_t size = get<uint8_t>(bytes, cursor, path);
+        if (cursor + size > bytes.size()) throw std::runtime_error("Truncated shard file: " + path);
+        mode.assign(reinterpret_cast<const char*>(bytes.data() + cursor), size);
+        cursor += size;
+    }
+    manifest.deviceCounts.resize(get<uint32_t>(bytes, cursor, path));
+    for (auto& count : manifest.deviceCounts) count = get<int32_t>(bytes, cursor, path);
+
+    std::vector<StoredCell> cells(cellCount);
+    for (auto& cell : cells) {
+        cell.index = get<uint32_t>(bytes, cursor, path);
+        uint32_t size = get<uint32_t>(bytes, cursor, path);
+        if (cell.index >= manifest.gridSize() || cursor + size > bytes.size()) {
+            throw std::runtime_error("Invalid cell in shard file: " + path);
+        }
+        cell.payload.assign(bytes.begin() + cursor, bytes.begin() + cursor + size);
+        cursor += size;
+    }
+    return cells;
+}
+
+} // namespace ShardState
+
+#endif // NBIOT_SHARD_STATE_H
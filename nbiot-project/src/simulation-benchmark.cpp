@@ -0,0 +1,598 @@
+/*
+ * Benchmark suite for the simulator kernels
+ *
+ * Times runSimulation over a grid of device counts and thread counts, and
+ * the per-device helpers (calculateDistanceEffect,
+ * calculateInterferenceEffect), the bootstrap of a cell, the PUR planner
+ * (planPur, replanPur) and saveResults over device counts. Each cell runs
+ * until it has both the requested repetitions and a minimum measured time,
+ * then reports the median devices/s and ns/device, the peak RSS reached while
+ * it ran and the heap allocations per run. Results are written as JSON.
+ * Given a baseline file from an earlier run, a cell whose ns/device grew by
+ * more than the threshold fails the run.
+ *
+ *   g++ -std=c++17 -O2 -Wall -pthread -o nbiot_benchmark simulation-benchmark.cpp -lm
+ *   ./nbiot_benchmark --output bench.json --baseline baseline.json --threshold 10
+ */
+
+#define NBIOT_SIMULATOR_NO_MAIN
+#include "simulation-script.cpp"
+
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <new>
+#include <set>
+
+// Toutes les allocations du programme passent par ces compteurs
+namespace AllocationCounter {
+std::atomic<uint64_t> count(0);
+std::atomic<uint64_t> bytes(0);
+
+inline void record(std::size_t size) {
+    count.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+}
+} // namespace AllocationCounter
+
+void* operator new(std::size_t size) {
+    AllocationCounter::record(size);
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* memory = std::malloc(size)) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    AllocationCounter::record(size);
+    if (size == 0) size = 1;
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    for (;;) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, align, size) == 0) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+// new[] et les variantes nothrow de libstdc++ se ramènent aux deux ci-dessus.
+// noinline : sinon GCC voit free() face à operator new et croit à une erreur
+__attribute__((noinline)) void operator delete(void* memory) noexcept { std::free(memory); }
+__attribute__((noinline)) void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+__attribute__((noinline)) void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+__attribute__((noinline)) void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+namespace Memory {
+
+// Ramène le pic RSS (VmHWM) au niveau courant ; false si le noyau refuse
+bool resetPeak() {
+    malloc_trim(0);
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs) return false;
+    clearRefs << "5";
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+}
+
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return strtol(line.c_str() + 6, nullptr, 10);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+} // namespace Memory
+
+struct BenchmarkOptions {
+    std::vector<long long> deviceCounts = {100, 1000, 10000, 100000, 1000000, 10000000};
+    std::vector<unsigned> threadCounts;
+    std::vector<std::string> modes = {"RAP", "EDT", "PUR"};
+    std::set<std::string> benchmarks;   // vide : tous
+    int repetitions = 3;
+    int warmup = 1;
+    double minTimeSeconds = 0.1;       // temps mesuré minimal par cellule
+    uint64_t seed = 1;
+    std::string kernel = "auto";
+    std::string engine = "closed-form";
+    std::string coverage = "distance";
+    std::string outputPath = "benchmark_results.json";
+    std::string baselinePath;
+    double thresholdPercent = 10.0;
+
+    bool enabled(const std::string& name) const {
+        return benchmarks.empty() || benchmarks.count(name) > 0;
+    }
+};
+
+struct Measurement {
+    std::string benchmark;
+    std::string mode;
+    std::string unit;        // "device", ou "row" pour saveResults
+    long long devices;
+    unsigned threads;
+    double seconds;          // médiane des répétitions
+    double minSeconds;
+    int runs;                // répétitions mesurées
+    double devicesPerSecond;
+    double nsPerDevice;
+    long peakRssKb;
+    double allocations;      // par répétition
+    double allocatedBytes;
+
+    std::string key() const {
+        return benchmark + "|" + mode + "|" + std::to_string(devices) + "|" + std::to_string(threads);
+    }
+};
+
+// Empêche le compilateur d'éliminer les calculs mesurés
+volatile double benchmarkSink = 0.0;
+
+template <class Body>
+Measurement measure(const BenchmarkOptions& options, const std::string& benchmark,
+                    const std::string& mode, const std::string& unit,
+                    long long devices, unsigned threads, Body body) {
+    for (int w = 0; w < options.warmup; w++) benchmarkSink = benchmarkSink + body();
+
+    // Une cellule de quelques microsecondes se répète jusqu'au temps minimal :
+    // sa médiane porte alors sur assez de mesures pour écarter le bruit
+    std::vector<double> times;
+    times.reserve(options.repetitions);
+    bool peakReset = Memory::resetPeak();
+    uint64_t allocationsBefore = AllocationCounter::count.load();
+    uint64_t bytesBefore = AllocationCounter::bytes.load();
+
+    double measured = 0.0;
+    while (static_cast<int>(times.size()) < options.repetitions || measured < options.minTimeSeconds) {
+        auto start = std::chrono::steady_clock::now();
+        benchmarkSink = benchmarkSink + body();
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        measured += times.back();
+    }
+    uint64_t allocations = AllocationCounter::count.load() - allocationsBefore;
+    uint64_t allocatedBytes = AllocationCounter::bytes.load() - bytesBefore;
+
+    Measurement m;
+    m.benchmark = benchmark;
+    m.mode = mode;
+    m.unit = unit;
+    m.devices = devices;
+    m.threads = threads;
+    m.runs = static_cast<int>(times.size());
+    m.allocations = static_cast<double>(allocations) / m.runs;
+    m.allocatedBytes = static_cast<double>(allocatedBytes) / m.runs;
+    m.peakRssKb = peakReset ? Memory::peakRssKb() : -1;
+
+    std::sort(times.begin(), times.end());
+    m.seconds = times[times.size() / 2];
+    m.minSeconds = times.front();
+    m.devicesPerSecond = devices / m.seconds;
+    m.nsPerDevice = m.seconds * 1e9 / devices;
+
+    std::cout << std::left << std::setw(28) << benchmark << std::setw(5) << mode
+              << std::right << std::setw(10) << devices << std::setw(4) << threads
+              << std::setw(14) << std::setprecision(4) << m.devicesPerSecond
+              << std::setw(11) << m.nsPerDevice
+              << std::setw(10) << m.peakRssKb
+              << std::setw(12) << m.allocations << std::endl;
+    return m;
+}
+
+std::vector<Measurement> runBenchmarks(const BenchmarkOptions& options) {
+    std::vector<Measurement> measurements;
+
+    std::cout << std::left << std::setw(28) << "benchmark" << std::setw(5) << "mode"
+              << std::right << std::setw(10) << "devices" << std::setw(4) << "thr"
+              << std::setw(14) << "devices/s" << std::setw(11) << "ns/device"
+              << std::setw(10) << "peak KB" << std::setw(12) << "allocs/run" << std::endl;
+
+    if (options.enabled("runSimulation")) {
+        RealisticSimulator simulator;
+        simulator.setKernel(options.kernel);
+        simulator.setEngine(options.engine);
+        simulator.setCoverageModel(options.coverage);
+        for (unsigned threads : options.threadCounts) {
+            // Le pool est créé hors mesure : seul le travail par cellule compte
+            TaskPool pool(threads);
+            for (const auto& mode : options.modes) {
+                for (long long devices : options.deviceCounts) {
+                    uint64_t seed = RandomStreams::cellSeed(options.seed, mode, static_cast<int>(devices), 0);
+                    measurements.push_back(measure(options, "runSimulation", mode, "device", devices, threads,
+                        [&] {
+                            return simulator.runSimulation(mode, static_cast<int>(devices), seed, &pool).avgEnergy;
+                        }));
+                }
+            }
+        }
+    }
+
+    if (options.enabled("calculateDistanceEffect")) {
+        RealisticSimulator simulator;
+        for (long long devices : options.deviceCounts) {
+            int n = static_cast<int>(devices);
+            measurements.push_back(measure(options, "calculateDistanceEffect", "", "device", devices, 1,
+                [&] {
+                    double sum = 0.0;
+                    for (int i = 0; i < n; i++) sum += simulator.calculateDistanceEffect(i, n);
+                    return sum;
+                }));
+        }
+    }
+
+    if (options.enabled("calculateInterferenceEffect")) {
+        RealisticSimulator simulator;
+        for (const auto& mode : options.modes) {
+            for (long long devices : options.deviceCounts) {
+                int n = static_cast<int>(devices);
+                measurements.push_back(measure(options, "calculateInterferenceEffect", mode, "device", devices, 1,
+                    [&] {
+                        double sum = 0.0;
+                        for (int i = 0; i < n; i++) sum += simulator.calculateInterferenceEffect(i, n, mode);
+                        return sum;
+                    }));
+            }
+        }
+    }
+
+    if (options.enabled("bootstrap")) {
+        // Réplicats bootstrap d'une cellule de 3 réplications (énergie et
+        // latence) ; débit en appareils rééchantillonnés
+        const int kReplicates = 100;
+        RealisticSimulator simulator;
+        simulator.setKernel(options.kernel);
+        TaskPool pool(options.threadCounts.back());
+        for (long long devices : options.deviceCounts) {
+            int n = static_cast<int>(devices);
+            std::vector<RealisticSimulator::SimulationResult> replications;
+            std::vector<std::vector<Bootstrap::Sample>> series(2);
+            std::vector<std::vector<int>> units;
+            for (int r = 0; r < 3; r++) {
+                replications.push_back(simulator.runSimulation(
+                    options.modes.front(), n, RandomStreams::cellSeed(options.seed, options.modes.front(), n, r),
+                    &pool));
+                units.push_back({r});
+            }
+            for (const auto& result : replications) {
+                series[0].push_back({&result.energySketch, result.avgEnergy});
+                series[1].push_back({&result.latencySketch, result.avgLatency});
+            }
+            Bootstrap::ClusterBootstrap engine(series, units, 0.95);
+            measurements.push_back(measure(options, "bootstrap", options.modes.front(), "device",
+                                           kReplicates * 3 * devices, 1,
+                [&] {
+                    double sum = 0.0;
+                    for (int b = 0; b < kReplicates; b++) sum += engine.replicate(options.seed, b).mean[0];
+                    return sum;
+                }));
+        }
+    }
+
+    if (options.enabled("planPur") || options.enabled("replanPur")) {
+        // Plan PUR d'une cellule (phases tirées comme dans le moteur), puis
+        // re-plan d'un UE sur dix qui quitte et rejoint la cellule
+        AccessConfig config;
+        config.purPlan = true;
+        const int64_t slot = static_cast<int64_t>(std::llround(config.purDataMs * 1000.0));
+        for (long long devices : options.deviceCounts) {
+            int n = static_cast<int>(devices);
+            uint64_t seed = RandomStreams::cellSeed(options.seed, "PUR", n, 0);
+            if (options.enabled("planPur")) {
+                measurements.push_back(measure(options, "planPur", "PUR", "UE", devices, 1,
+                    [&] { return static_cast<double>(AccessEngine::planPur(config, seed, n, false).planner.assigned()); }));
+            }
+            if (options.enabled("replanPur")) {
+                PurPlan plan = AccessEngine::planPur(config, seed, n, false);
+                long long churned = (devices + 9) / 10;
+                measurements.push_back(measure(options, "replanPur", "PUR", "UE", churned, 1,
+                    [&] {
+                        for (int id = 0; id < n; id += 10) plan.planner.release(static_cast<uint32_t>(id));
+                        for (int id = 0; id < n; id += 10) {
+                            plan.planner.assign(static_cast<uint32_t>(id),
+                                                static_cast<uint32_t>((plan.ready[id] + slot - 1) / slot));
+                        }
+                        return static_cast<double>(plan.planner.assigned());
+                    }));
+            }
+        }
+    }
+
+    if (options.enabled("saveResults")) {
+        // Les résultats du balayage standard, écrits dans un répertoire temporaire
+        RealisticSimulator simulator;
+        simulator.setKernel(options.kernel);
+        TaskPool pool(options.threadCounts.back());
+        std::vector<RealisticSimulator::SimulationResult> results;
+        for (const auto& mode : options.modes) {
+            for (int devices : {100, 500, 1000, 5000, 10000}) {
+                results.push_back(simulator.runSimulation(
+                    mode, devices, RandomStreams::cellSeed(options.seed, mode, devices, 0), &pool));
+            }
+        }
+
+        char directory[] = "/tmp/nbiot-benchmark-XXXXXX";
+        char previous[4096];
+        if (mkdtemp(directory) == nullptr || getcwd(previous, sizeof(previous)) == nullptr ||
+            chdir(directory) != 0) {
+            throw std::runtime_error("Cannot create a temporary directory for saveResults");
+        }
+        // saveResults écrit aussi sur la sortie standard : on la coupe pendant la mesure
+        std::streambuf* console = std::cout.rdbuf();
+        std::ostringstream discarded;
+        auto save = [&] {
+            std::cout.rdbuf(discarded.rdbuf());
+            simulator.saveResults(results);
+            std::cout.rdbuf(console);
+            discarded.str("");
+            return 0.0;
+        };
+        Measurement m = measure(options, "saveResults", "", "row",
+                                static_cast<long long>(results.size()), 1, save);
+        measurements.push_back(m);
+
+        std::remove("real_simulation_results.csv");
+        std::remove("detailed_results.txt");
+        if (chdir(previous) != 0 || rmdir(directory) != 0) {
+            std::cerr << "Note: could not remove " << directory << std::endl;
+        }
+    }
+
+    return measurements;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(const std::string& path, const BenchmarkOptions& options,
+               const std::vector<Measurement>& measurements) {
+    std::ofstream json(path);
+    if (!json) throw std::runtime_error("Cannot create " + path);
+    json << std::setprecision(10);
+
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    json << "{\n";
+    json << "  \"schema\": 1,\n";
+    json << "  \"timestamp\": \"" << timestamp << "\",\n";
+    json << "  \"kernel\": \"" << DeviceKernel::isaName(DeviceKernel::resolveIsa(options.kernel)) << "\",\n";
+    json << "  \"engine\": \"" << options.engine << "\",\n";
+    json << "  \"coverage\": \"" << options.coverage << "\",\n";
+    json << "  \"hardwareThreads\": " << TaskPool::defaultThreadCount() << ",\n";
+    json << "  \"repetitions\": " << options.repetitions << ",\n";
+    json << "  \"minTimeSeconds\": " << options.minTimeSeconds << ",\n";
+    json << "  \"results\": [\n";
+    for (size_t i = 0; i < measurements.size(); i++) {
+        const Measurement& m = measurements[i];
+        json << "    {\"benchmark\": \"" << jsonEscape(m.benchmark) << "\", \"mode\": \""
+             << jsonEscape(m.mode) << "\", \"unit\": \"" << m.unit << "\", \"devices\": " << m.devices
+             << ", \"threads\": " << m.threads << ", \"seconds\": " << m.seconds
+             << ", \"minSeconds\": " << m.minSeconds << ", \"runs\": " << m.runs
+             << ", \"devicesPerSecond\": " << m.devicesPerSecond
+             << ", \"nsPerDevice\": " << m.nsPerDevice << ", \"peakRssKb\": " << m.peakRssKb
+             << ", \"allocations\": " << m.allocations << ", \"allocatedBytes\": " << m.allocatedBytes
+             << "}" << (i + 1 < measurements.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    if (!json) throw std::runtime_error("Error while writing " + path);
+}
+
+// Lit le tableau "results" d'un fichier écrit par writeJson : objets plats,
+// valeurs chaînes ou nombres
+std::vector<std::map<std::string, std::string>> readJsonResults(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open baseline " + path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    size_t pos = text.find("\"results\"");
+    if (pos == std::string::npos || (pos = text.find('[', pos)) == std::string::npos) {
+        throw std::runtime_error("No results array in baseline " + path);
+    }
+    pos++;
+
+    auto skipSpace = [&] {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    };
+    auto expect = [&](char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) {
+            throw std::runtime_error(std::string("Malformed baseline: expected '") + c + "'");
+        }
+        pos++;
+    };
+    auto readString = [&] {
+        expect('"');
+        std::string value;
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+            value += text[pos++];
+        }
+        expect('"');
+        return value;
+    };
+
+    std::vector<std::map<std::string, std::string>> results;
+    for (;;) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == ']') break;
+        if (!results.empty()) expect(',');
+        expect('{');
+        std::map<std::string, std::string> object;
+        for (;;) {
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') { pos++; break; }
+            if (!object.empty()) expect(',');
+            std::string key = readString();
+            expect(':');
+            skipSpace();
+            if (pos < text.size() && text[pos] == '"') {
+                object[key] = readString();
+            } else {
+                size_t end = text.find_first_of(",}", pos);
+                if (end == std::string::npos) throw std::runtime_error("Malformed baseline value");
+                object[key] = text.substr(pos, end - pos);
+                pos = end;
+            }
+        }
+        results.push_back(object);
+    }
+    return results;
+}
+
+// Nombre de cellules plus lentes que la référence au-delà du seuil
+int compareWithBaseline(const BenchmarkOptions& options, const std::vector<Measurement>& measurements) {
+    std::map<std::string, double> baseline;
+    for (const auto& entry : readJsonResults(options.baselinePath)) {
+        std::string key = entry.at("benchmark") + "|" + entry.at("mode") + "|"
+                        + std::to_string(std::stoll(entry.at("devices"))) + "|"
+                        + std::to_string(std::stoul(entry.at("threads")));
+        baseline[key] = std::stod(entry.at("nsPerDevice"));
+    }
+
+    std::cout << "\nComparison with " << options.baselinePath << " (threshold +"
+              << options.thresholdPercent << "% ns/device)" << std::endl;
+    int regressions = 0, compared = 0;
+    for (const auto& m : measurements) {
+        auto found = baseline.find(m.key());
+        if (found == baseline.end() || found->second <= 0.0) continue;
+        compared++;
+        double change = (m.nsPerDevice / found->second - 1.0) * 100.0;
+        if (change > options.thresholdPercent) {
+            regressions++;
+            std::cout << "  REGRESSION " << m.benchmark << " " << m.mode << " devices=" << m.devices
+                      << " threads=" << m.threads << ": " << found->second << " -> "
+                      << m.nsPerDevice << " ns/device (+" << change << "%)" << std::endl;
+        }
+    }
+    std::cout << "  " << compared << " cells compared, " << (measurements.size() - compared)
+              << " without baseline, " << regressions << " regression(s)" << std::endl;
+    return regressions;
+}
+
+template <class T>
+std::vector<T> parseList(const char* text) {
+    std::vector<T> values;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (!item.empty()) values.push_back(static_cast<T>(strtod(item.c_str(), nullptr)));
+    }
+    return values;
+}
+
+void printBenchmarkUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--devices LIST] [--threads LIST] [--modes LIST]"
+              << " [--benchmarks LIST] [--repetitions R] [--min-time MS] [--warmup W] [--seed S]"
+              << " [--kernel K] [--engine E] [--coverage M] [--output FILE] [--baseline FILE] [--threshold PCT]"
+              << std::endl;
+    std::cout << "  --devices LIST     device counts (default: 100,1000,...,10000000)" << std::endl;
+    std::cout << "  --threads LIST     thread counts for runSimulation (default: 1,2,4,... up to all cores)" << std::endl;
+    std::cout << "  --modes LIST       modes to benchmark (default: RAP,EDT,PUR)" << std::endl;
+    std::cout << "  --benchmarks LIST  subset of runSimulation,calculateDistanceEffect,"
+              << "calculateInterferenceEffect,bootstrap,planPur,replanPur,saveResults" << std::endl;
+    std::cout << "  --repetitions R    minimum timed runs per cell, the median is reported (default: 3)" << std::endl;
+    std::cout << "  --min-time MS      minimum measured time per cell, runs repeat until reached (default: 100)"
+              << std::endl;
+    std::cout << "  --warmup W         untimed runs per cell (default: 1)" << std::endl;
+    std::cout << "  --output FILE      JSON results (default: benchmark_results.json)" << std::endl;
+    std::cout << "  --baseline FILE    earlier JSON results to compare against" << std::endl;
+    std::cout << "  --threshold PCT    allowed ns/device increase before failing (default: 10)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            options.deviceCounts = parseList<long long>(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threadCounts = parseList<unsigned>(argv[++i]);
+        } else if (strcmp(argv[i], "--modes") == 0 && i + 1 < argc) {
+            std::vector<std::string> names;
+            std::stringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (ModeRegistry::instance().find(name) == nullptr) {
+                    std::cerr << "Unknown mode: " << name << std::endl;
+                    return 1;
+                }
+                names.push_back(name);
+            }
+            options.modes = names;
+        } else if (strcmp(argv[i], "--benchmarks") == 0 && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ',')) options.benchmarks.insert(name);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            options.repetitions = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.minTimeSeconds = std::max(0.0, strtod(argv[++i], nullptr)) / 1000.0;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options.warmup = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            options.kernel = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            options.engine = argv[++i];
+        } else if (strcmp(argv[i], "--coverage") == 0 && i + 1 < argc) {
+            options.coverage = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options.outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options.baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            options.thresholdPercent = strtod(argv[++i], nullptr);
+        } else {
+            printBenchmarkUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (options.threadCounts.empty()) {
+        unsigned cores = TaskPool::defaultThreadCount();
+        for (unsigned threads = 1; threads < cores; threads *= 2) options.threadCounts.push_back(threads);
+        options.threadCounts.push_back(cores);
+    }
+    for (long long devices : options.deviceCounts) {
+        if (devices < 1 || devices > 2000000000LL) {
+            std::cerr << "Device counts must be between 1 and 2e9" << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        std::vector<Measurement> measurements = runBenchmarks(options);
+        writeJson(options.outputPath, options, measurements);
+        std::cout << "\nResults written to " << options.outputPath << std::endl;
+
+        if (!options.baselinePath.empty() && compareWithBaseline(options, measurements) > 0) {
+            return 2;
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
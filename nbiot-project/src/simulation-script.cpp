@@ -5,12 +5,45 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <vector>
 #include <random>
 #include <cmath>
 #include <iomanip>
+#include <limits>
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <numeric>
+#include <string>
+#include <sys/stat.h>
+
+#include "access-engine.h"
+#include "bootstrap.h"
+#include "device-kernel.h"
+#include "interference-grid.h"
+#include "lifetime-engine.h"
+#include "mode-registry.h"
+#include "profiler.h"
+#include "random-streams.h"
+#include "report-writer.h"
+#include "result-cache.h"
+#include "result-stream.h"
+#include "sensitivity-analysis.h"
+#include "sequential-stopping.h"
+#include "shard-state.h"
+#include "streaming-stats.h"
+#include "task-pool.h"
+#include "trace-reader.h"
+#include "trace-writer.h"
 
 class RealisticSimulator {
 private:
@@ -18,10 +51,231 @@ private:
     std::normal_distribution<double> normal_dist;
     std::uniform_real_distribution<double> uniform_dist;
     
+    // Paramètres d'exécution du balayage
+    unsigned threadCount;
+    uint64_t masterSeed;
+    bool seedFixed;
+    bool keepSamples;
+    DeviceKernel::Isa kernelIsa;
+    std::vector<std::string> modes;
+    bool discreteEvents;
+    AccessConfig accessConfig;
+    bool spatialInterference;
+    bool coverageModel;
+    std::string tracePath;
+    TraceFormat::Codec traceCodec;
+    std::unique_ptr<TraceWriter> traceWriter;
+    std::string profilePath;
+    std::vector<int> deviceCounts;
+    std::string cacheDirectory;
+    bool pruneCache;
+    double confidenceTarget;
+    int maxRepeats;
+    int fixedUnits;
+    int bootstrapReplicates;
+    bool commonRandomNumbers;
+    bool antitheticVariates;
+    uint32_t shardIndex;
+    uint32_t shardCount;
+    std::string outputDirectory;
+    bool lifetimeEnabled;
+    LifetimeConfig lifetimeConfig;
+    std::unique_ptr<ResultStream> resultStream;
+    double streamProgressSeconds;
+    
+    // Taille des blocs d'appareils répartis entre les threads
+    static const int kDevicesPerChunk = 2048;
+    
+    // Interférence spatiale : portée en côtés de cellule, créneaux par période.
+    // π·0,1²/32 ≈ 1/1000 : même charge moyenne que le modèle uniforme (N/1000)
+    static constexpr double kInterferenceRange = 0.1;
+    static const int kInterferenceSlots = 32;
+    
+    // Version du modèle pour le cache : à incrémenter à chaque changement
+    // du calcul d'une cellule qui n'apparaît pas dans cacheModelHash()
+    static constexpr const char* kModelVersion = "cell-model-2";
+    
+    // Unités par cellule sans --ci-target (défaut de --repeats), et à la
+    // première vague avec
+    static constexpr int kFixedUnits = 3;
+    static constexpr int kMinUnits = 3;
+    
+    // Unités par cellule à partir desquelles les intervalles bootstrap couvrent
+    static constexpr size_t kBootstrapMinUnits = 10;
+    // ... et au-delà desquelles le jackknife (quadratique en unités) et la
+    // mémoire des réplicats ne valent plus l'intervalle de Student
+    static constexpr size_t kBootstrapMaxUnits = 5000;
+    
 public:
     RealisticSimulator() : rng(std::random_device{}()),
                           normal_dist(0.0, 1.0),
-                          uniform_dist(0.0, 1.0) {}
+                          uniform_dist(0.0, 1.0),
+                          threadCount(0),
+                          masterSeed(0),
+                          seedFixed(false),
+                          keepSamples(false),
+                          kernelIsa(DeviceKernel::detectIsa()),
+                          modes({"RAP", "EDT", "PUR"}),
+                          discreteEvents(false),
+                          spatialInterference(false),
+                          coverageModel(false),
+                          traceCodec(TraceFormat::Codec::None),
+                          deviceCounts({100, 500, 1000, 5000, 10000}),
+                          pruneCache(false),
+                          confidenceTarget(0.0),
+                          maxRepeats(200),
+                          fixedUnits(kFixedUnits),
+                          bootstrapReplicates(1000),
+                          commonRandomNumbers(false),
+                          antitheticVariates(false),
+                          shardIndex(0),
+                          shardCount(0),
+                          lifetimeEnabled(false),
+                          streamProgressSeconds(0.5) {}
+    
+    void setThreadCount(unsigned threads) { threadCount = threads; }
+    
+    void setSeed(uint64_t seed) {
+        masterSeed = seed;
+        seedFixed = true;
+    }
+    
+    // Conserver les valeurs par appareil (désactivé : statistiques en flux)
+    void setKeepSamples(bool keep) { keepSamples = keep; }
+    
+    // "auto", "scalar", "avx2" ou "avx512" ; un jeu que le CPU ne supporte pas est refusé
+    void setKernel(const std::string& name) { kernelIsa = DeviceKernel::resolveIsa(name); }
+    
+    // Modes du balayage, tous enregistrés dans ModeRegistry
+    void setModes(const std::vector<std::string>& names) {
+        for (const auto& name : names) ModeRegistry::instance().get(name);
+        modes = names;
+    }
+    
+    // "closed-form" (modèle analytique) ou "des" (moteur à événements discrets)
+    void setEngine(const std::string& name) {
+        if (name != "closed-form" && name != "des") {
+            throw std::invalid_argument("Unknown engine: " + name);
+        }
+        discreteEvents = name == "des";
+    }
+    
+    // "uniform" (charge moyenne N/1000) ou "spatial" (voisins dans le même créneau)
+    void setInterferenceModel(const std::string& name) {
+        if (name != "uniform" && name != "spatial") {
+            throw std::invalid_argument("Unknown interference model: " + name);
+        }
+        spatialInterference = name == "spatial";
+    }
+    
+    // "distance" (pénalité linéaire) ou "ce" (bilan de liaison et niveaux CE, coverage-tables.h)
+    void setCoverageModel(const std::string& name) {
+        if (name != "distance" && name != "ce") {
+            throw std::invalid_argument("Unknown coverage model: " + name);
+        }
+        coverageModel = name == "ce";
+    }
+    
+    // Trace binaire par appareil (vide : pas de trace)
+    void setTrace(const std::string& path, bool compress) {
+        tracePath = path;
+        traceCodec = compress ? TraceFormat::Codec::ShuffleRle : TraceFormat::Codec::None;
+    }
+    
+    // Trace Chrome des phases instrumentées (vide : pas d'instrumentation)
+    void setProfile(const std::string& path) { profilePath = path; }
+    
+    // Tailles de cellule du balayage
+    void setDeviceCounts(const std::vector<int>& counts) { deviceCounts = counts; }
+    
+    // Cache des cellules déjà calculées (vide : pas de cache) ; prune
+    // supprime les résultats des autres versions du modèle
+    void setCache(const std::string& directory, bool prune) {
+        cacheDirectory = directory;
+        pruneCache = prune;
+    }
+    
+    // Demi-largeur relative visée pour l'IC à 95 % (0 : 3 répétitions fixes)
+    // et nombre maximal de réplications par cellule
+    void setConfidenceTarget(double target, int maximum) {
+        if (target < 0.0 || maximum < 1) throw std::invalid_argument("Invalid replication target");
+        confidenceTarget = target;
+        maxRepeats = maximum;
+    }
+    
+    // Unités par cellule sans --ci-target (réplications, ou paires antithétiques)
+    void setFixedUnits(int units) {
+        if (units < 1) throw std::invalid_argument("Invalid replication count");
+        fixedUnits = units;
+    }
+    
+    // Réplicats du bootstrap des intervalles de l'analyse statistique (0 : aucun)
+    void setBootstrapReplicates(int replicates) {
+        if (replicates < 0) throw std::invalid_argument("Invalid bootstrap replicate count");
+        bootstrapReplicates = replicates;
+    }
+    
+    // Nombres aléatoires communs entre modes et réplications antithétiques
+    void setVarianceReduction(bool common, bool antithetic) {
+        commonRandomNumbers = common;
+        antitheticVariates = antithetic;
+    }
+    
+    // Ne simuler que les cellules d'indice ≡ index (mod count) de la grille
+    // et enregistrer leur état partiel au lieu des résultats
+    void setShard(uint32_t index, uint32_t count) {
+        if (count < 1 || index >= count) throw std::invalid_argument("Invalid shard");
+        shardIndex = index;
+        shardCount = count;
+    }
+    
+    // Répertoire des fichiers produits (vide : répertoire courant)
+    void setOutputDirectory(const std::string& directory) {
+        if (!directory.empty() && mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Cannot create output directory: " + directory);
+        }
+        outputDirectory = directory;
+    }
+    
+    bool isSharded() const { return shardCount > 0; }
+    
+    // Durée de vie simulée appareil par appareil après le balayage
+    void setLifetime(const LifetimeConfig& config) {
+        LifetimeEngine(config, 0);   // valide la configuration
+        lifetimeConfig = config;
+        lifetimeEnabled = true;
+    }
+    
+    std::string outputPath(const std::string& name) const {
+        return outputDirectory.empty() ? name : outputDirectory + "/" + name;
+    }
+    
+    // Flux NDJSON des résultats au fil du balayage (result-stream.h) ; état
+    // partiel des grandes cellules toutes les `progressSeconds` (0 : jamais)
+    void setStream(const std::string& target, double progressSeconds) {
+        if (progressSeconds < 0.0) throw std::invalid_argument("Invalid stream progress interval");
+        resultStream.reset(new ResultStream(target));
+        streamProgressSeconds = progressSeconds;
+    }
+    
+    // Durée simulée par cellule avec le moteur à événements discrets
+    void setSimulatedDays(double days) { accessConfig.simulatedDays = days; }
+    
+    // Ressources PUR planifiées sur `tones` sous-porteuses (rapport de
+    // dimensionnement, et créneaux réels avec --engine des)
+    void setPurPlan(int tones) {
+        if (tones < 1 || tones > 12) throw std::invalid_argument("PUR tones must be between 1 and 12");
+        accessConfig.purPlan = true;
+        accessConfig.purTones = tones;
+    }
+    
+    // Constantes du modèle d'appareil que --sensitivity fait varier avec
+    // celles des modes ; par défaut, les valeurs du balayage
+    struct ModelConstants {
+        double variationAmplitude = 0.1;   // variation individuelle ±10 % (DeviceKernel::kVariationLow/Span)
+        double noiseSigma = 0.1;           // écart-type du bruit gaussien (DeviceKernel::kNoiseSigma)
+        double batteryJ = 18000.0;         // 5 Wh
+    };
     
     struct SimulationResult {
         std::string mode;
@@ -31,8 +285,22 @@ public:
         double energyStdDev;
         double latencyStdDev;
         double batteryLife;
+        
+        // Statistiques en flux, toujours disponibles
+        RunningStats energyStats;
+        RunningStats latencyStats;
+        QuantileSketch energySketch;
+        QuantileSketch latencySketch;
+        
+        // Remplis uniquement avec setKeepSamples(true)
         std::vector<double> individualEnergies;
         std::vector<double> individualLatencies;
+        
+        // Compteurs du moteur à événements discrets (nuls en closed-form)
+        uint64_t simulatedEvents = 0;
+        uint64_t collisions = 0;
+        uint64_t failedAccesses = 0;
+        double failedEnergy = 0.0;       // J des rapports abandonnés, reportés sur les livrés
     };
     
     double calculateDistanceEffect(int deviceIndex, int totalDevices) {
@@ -46,15 +314,8 @@ public:
     
     double calculateInterferenceEffect(int deviceIndex, int totalDevices, const std::string& mode) {
         // Simule l'interférence (plus d'appareils = plus d'interférence)
-        double interference = 0.0;
-        
-        if (mode == "RAP") {
-            interference = (totalDevices / 1000.0) * 0.3;
-        } else if (mode == "EDT") {
-            interference = (totalDevices / 1000.0) * 0.2;
-        } else { // PUR
-            interference = (totalDevices / 1000.0) * 0.1;
-        }
+        double interference = (totalDevices / 1000.0)
+                            * ModeRegistry::instance().get(mode).interferenceCoeff;
         
         // Variation aléatoire
         interference *= (0.8 + uniform_dist(rng) * 0.4);
@@ -62,110 +323,545 @@ public:
         return 1.0 + interference;
     }
     
+    // Durée de vie en années pour une énergie par rapport donnée : un rapport
+    // par période du moteur d'accès (une heure, comme le modèle closed-form)
+    double batteryLifeYears(double energyPerReport, double batteryJ) const {
+        double reportsPerDay = 86400000.0 / accessConfig.reportingPeriodMs;
+        return batteryJ / (energyPerReport * reportsPerDay * 365.0);
+    }
+    
     SimulationResult runSimulation(const std::string& mode, int numDevices) {
+        uint64_t streamSeed = (static_cast<uint64_t>(rng()) << 32) | rng();
+        return runSimulation(mode, numDevices, streamSeed, nullptr);
+    }
+    
+    SimulationResult runSimulation(const std::string& mode, int numDevices,
+                                   uint64_t streamSeed, TaskPool* pool, int repeat = 0,
+                                   bool antithetic = false) {
+        // Le mode est résolu une fois par cellule
+        return runSimulation(ModeRegistry::instance().get(mode), ModelConstants(), numDevices, streamSeed, pool,
+                             repeat, antithetic);
+    }
+    
+    // Une cellule d'un mode et de constantes donnés explicitement (--sensitivity
+    // en fait varier les valeurs)
+    SimulationResult runSimulation(const ModeDescriptor& descriptor, const ModelConstants& constants,
+                                   int numDevices, uint64_t streamSeed, TaskPool* pool, int repeat,
+                                   bool antithetic) {
+        NBIOT_PROFILE_SCOPE("runSimulation");
+        NBIOT_PROFILE_COUNTER("devices", numDevices);
+        const std::string& mode = descriptor.name;
         SimulationResult result;
         result.mode = mode;
         result.numDevices = numDevices;
         
-        // Paramètres de base avec variations aléatoires
-        double baseEnergy, baseLatency;
+        // Flux propre à la cellule : paramètres de base et variation finale
+        RandomStreams::CellStream cellStream(streamSeed, antithetic);
         
-        // Chaque simulation a des valeurs de base DIFFÉRENTES
-        if (mode == "RAP") {
-            baseEnergy = 4.0 + uniform_dist(rng) * 2.0;  // 4.0-6.0 J
-            baseLatency = 400.0 + uniform_dist(rng) * 200.0;  // 400-600 ms
-        } else if (mode == "EDT") {
-            baseEnergy = 3.0 + uniform_dist(rng) * 1.5;  // 3.0-4.5 J
-            baseLatency = 200.0 + uniform_dist(rng) * 100.0;  // 200-300 ms
-        } else { // PUR
-            baseEnergy = 2.0 + uniform_dist(rng) * 1.0;  // 2.0-3.0 J
-            baseLatency = 100.0 + uniform_dist(rng) * 80.0;  // 100-180 ms
-        }
-        
-        // Simuler chaque appareil individuellement
-        for (int i = 0; i < numDevices; i++) {
-            // Variation aléatoire individuelle
-            double individualVariation = 0.9 + uniform_dist(rng) * 0.2;  // ±10%
-            
-            // Effet distance
-            double distanceEffect = calculateDistanceEffect(i, numDevices);
-            
-            // Effet interférence
-            double interferenceEffect = calculateInterferenceEffect(i, numDevices, mode);
+        if (discreteEvents) {
+            runAccessSimulation(result, descriptor, constants, streamSeed, antithetic);
+            return result;
+        }
+        
+        DeviceKernel::CellParams cell = cellParams(descriptor, constants, numDevices, streamSeed, antithetic,
+                                                   cellStream);
+        
+        // Index des voisins, construit une fois par cellule (appareils fixes)
+        std::unique_ptr<InterferenceGrid> grid;
+        if (spatialInterference) {
+            NBIOT_PROFILE_SCOPE("interferenceGrid.build");
+            grid = buildInterferenceGrid(cell);
+        }
+        
+        if (keepSamples) {
+            result.individualEnergies.resize(numDevices);
+            result.individualLatencies.resize(numDevices);
+        }
+        
+        // Les appareils sont découpés en blocs de taille fixe ; les tirages
+        // sont indexés par appareil : le résultat ne dépend pas des threads
+        int chunkCount = (numDevices + kDevicesPerChunk - 1) / kDevicesPerChunk;
+        std::vector<RunningStats> energyPartials(chunkCount);
+        std::vector<RunningStats> latencyPartials(chunkCount);
+        std::mutex sketchMutex;
+        const DeviceKernel::Isa isa = kernelIsa;
+        // Noyau aux constantes repliées, sauf pour un point de --sensitivity
+        const DeviceKernel::BlockFunction simulateBlock = descriptor.usesModeConstants(cell)
+                                                        ? descriptor.simulateBlock
+                                                        : descriptor.simulateBlockRuntime;
+        TraceWriter* trace = traceWriter.get();
+        const uint8_t traceMode = trace != nullptr ? trace->modeIndex(mode) : 0;
+        
+        // État partiel pour le flux : statistiques des tranches finies, à part
+        // de la fusion ordonnée qui donne le résultat
+        ResultStream* stream = chunkCount > 1 && streamProgressSeconds > 0.0 && resultStream
+                             && resultStream->hasConsumer() ? resultStream.get() : nullptr;
+        std::mutex progressMutex;
+        RunningStats progressEnergy, progressLatency;
+        int64_t progressDevices = 0;
+        const auto cellStart = std::chrono::steady_clock::now();
+        auto lastProgress = cellStart;
+        
+        auto simulateChunk = [&](int chunk) {
+            NBIOT_PROFILE_SCOPE("deviceChunk");
+            int begin = chunk * kDevicesPerChunk;
+            int end = std::min(numDevices, begin + kDevicesPerChunk);
+            QuantileSketch energySketch, latencySketch;
+            DeviceKernel::Block block;
+            DeviceKernel::BlockSummary summary;
+            TraceWriter::Rows traceRows;
             
-            // Bruit aléatoire
-            double noise = 0.95 + normal_dist(rng) * 0.1;
+            // Simuler les appareils par blocs vectorisés
+            for (int first = begin; first < end; first += DeviceKernel::kBlockSize) {
+                int count = std::min(DeviceKernel::kBlockSize, end - first);
+                if (grid) {
+                    NBIOT_PROFILE_SCOPE("interferenceGrid.query");
+                    for (int k = 0; k < DeviceKernel::kBlockSize; k++) {
+                        block.interference[k] = k < count ? grid->interferenceAt(first + k) : 0.0;
+                    }
+                }
+                {
+                    // Tirages aléatoires et modèle d'appareil, fusionnés dans le noyau
+                    NBIOT_PROFILE_SCOPE("simulateBlock");
+                    simulateBlock(isa, cell, first, block);
+                }
+                {
+                    NBIOT_PROFILE_SCOPE("summarizeBlock");
+                    DeviceKernel::summarizeBlock(isa, block.energy, count, summary);
+                    energyPartials[chunk].merge(RunningStats::fromMoments(
+                        summary.count, summary.mean, summary.m2, summary.min, summary.max));
+                    DeviceKernel::summarizeBlock(isa, block.latency, count, summary);
+                    latencyPartials[chunk].merge(RunningStats::fromMoments(
+                        summary.count, summary.mean, summary.m2, summary.min, summary.max));
+                }
+                {
+                    NBIOT_PROFILE_SCOPE("quantileSketch");
+                    energySketch.addAll(block.energy, count);
+                    latencySketch.addAll(block.latency, count);
+                }
+                
+                if (keepSamples) {
+                    std::copy(block.energy, block.energy + count,
+                              result.individualEnergies.begin() + first);
+                    std::copy(block.latency, block.latency + count,
+                              result.individualLatencies.begin() + first);
+                }
+                
+                if (trace != nullptr) {
+                    NBIOT_PROFILE_SCOPE("traceRows");
+                    traceRows.mode.insert(traceRows.mode.end(), count, traceMode);
+                    traceRows.cellDevices.insert(traceRows.cellDevices.end(), count, numDevices);
+                    traceRows.repeat.insert(traceRows.repeat.end(), count, repeat);
+                    for (int k = 0; k < count; k++) traceRows.device.push_back(first + k);
+                    traceRows.x.insert(traceRows.x.end(), block.gridX, block.gridX + count);
+                    traceRows.y.insert(traceRows.y.end(), block.gridY, block.gridY + count);
+                    traceRows.energy.insert(traceRows.energy.end(), block.energy, block.energy + count);
+                    traceRows.latency.insert(traceRows.latency.end(), block.latency, block.latency + count);
+                }
+            }
             
-            // Calculer énergie pour cet appareil
-            double deviceEnergy = baseEnergy * individualVariation * distanceEffect 
-                                * interferenceEffect * noise;
+            // Un lot par tranche d'appareils : l'écriture se fait en arrière-plan
+            if (trace != nullptr) {
+                NBIOT_PROFILE_SCOPE("trace.append");
+                trace->append(traceRows);
+            }
             
-            // Calculer latence pour cet appareil
-            double deviceLatency = baseLatency * individualVariation * distanceEffect 
-                                 * (1.0 + (numDevices / 10000.0)) * noise;
+            if (stream != nullptr) {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                progressEnergy.merge(energyPartials[chunk]);
+                progressLatency.merge(latencyPartials[chunk]);
+                progressDevices += end - begin;
+                auto now = std::chrono::steady_clock::now();
+                if (progressDevices < numDevices
+                    && std::chrono::duration<double>(now - lastProgress).count() >= streamProgressSeconds) {
+                    lastProgress = now;
+                    stream->progress({mode, numDevices, repeat, progressDevices, progressEnergy.mean(),
+                                      progressLatency.mean(),
+                                      std::chrono::duration<double>(now - cellStart).count()});
+                }
+            }
             
-            result.individualEnergies.push_back(deviceEnergy);
-            result.individualLatencies.push_back(deviceLatency);
-        }
+            // La fusion des sketches est une somme exacte : l'ordre importe peu
+            NBIOT_PROFILE_SCOPE("sketchMerge");
+            std::lock_guard<std::mutex> lock(sketchMutex);
+            result.energySketch.merge(energySketch);
+            result.latencySketch.merge(latencySketch);
+        };
         
-        // Calculer statistiques
-        result.avgEnergy = std::accumulate(result.individualEnergies.begin(), 
-                                         result.individualEnergies.end(), 0.0) 
-                         / numDevices;
-        
-        result.avgLatency = std::accumulate(result.individualLatencies.begin(), 
-                                          result.individualLatencies.end(), 0.0) 
-                          / numDevices;
-        
-        // Calculer écarts-types
-        double energyVariance = 0.0;
-        double latencyVariance = 0.0;
+        if (pool != nullptr && chunkCount > 1) {
+            TaskPool::TaskGroup chunks;
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                pool->submit(chunks, [&simulateChunk, chunk] { simulateChunk(chunk); });
+            }
+            pool->wait(chunks);
+        } else {
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                simulateChunk(chunk);
+            }
+        }
         
-        for (int i = 0; i < numDevices; i++) {
-            energyVariance += pow(result.individualEnergies[i] - result.avgEnergy, 2);
-            latencyVariance += pow(result.individualLatencies[i] - result.avgLatency, 2);
+        // Calculer statistiques (fusion dans l'ordre des blocs)
+        NBIOT_PROFILE_SCOPE("mergeStatistics");
+        for (int chunk = 0; chunk < chunkCount; chunk++) {
+            result.energyStats.merge(energyPartials[chunk]);
+            result.latencyStats.merge(latencyPartials[chunk]);
         }
         
-        result.energyStdDev = sqrt(energyVariance / numDevices);
-        result.latencyStdDev = sqrt(latencyVariance / numDevices);
+        result.avgEnergy = result.energyStats.mean();
+        result.avgLatency = result.latencyStats.mean();
+        result.energyStdDev = result.energyStats.stdDev();
+        result.latencyStdDev = result.latencyStats.stdDev();
         
         // Calculer durée vie batterie (avec variation)
-        double dailyEnergy = result.avgEnergy * 24.0;  // 1 paquet par jour
-        double batteryCapacity = 18000.0;  // 5 Wh en Joules
-        result.batteryLife = batteryCapacity / (dailyEnergy * 365.0);
+        result.batteryLife = batteryLifeYears(result.avgEnergy, constants.batteryJ);
         
         // Ajouter variation aléatoire finale
-        result.batteryLife *= (0.9 + uniform_dist(rng) * 0.2);
+        result.batteryLife *= (0.9 + cellStream.uniform() * 0.2);
         
         return result;
     }
     
-    void runMultipleSimulations() {
-        std::vector<int> deviceCounts = {100, 500, 1000, 5000, 10000};
-        std::vector<std::string> modes = {"RAP", "EDT", "PUR"};
+    // Tout ce qui est commun aux appareils, calculé une seule fois par cellule ;
+    // consomme les deux premiers tirages du flux de la cellule
+    DeviceKernel::CellParams cellParams(const ModeDescriptor& descriptor, const ModelConstants& constants,
+                                        int numDevices, uint64_t streamSeed, bool antithetic,
+                                        RandomStreams::CellStream& cellStream) const {
+        // Chaque simulation a des valeurs de base DIFFÉRENTES
+        double baseEnergy = descriptor.energyMin + cellStream.uniform() * descriptor.energySpan;
+        double baseLatency = descriptor.latencyMin + cellStream.uniform() * descriptor.latencySpan;
         
-        std::vector<SimulationResult> allResults;
+        DeviceKernel::CellParams cell;
+        cell.seed = streamSeed;
+        cell.numDevices = numDevices;
+        cell.baseEnergy = baseEnergy;
+        cell.baseLatency = baseLatency;
+        double gridSize = sqrt(numDevices);
+        cell.gridWidth = (int)gridSize;
+        cell.distanceScale = 0.5 / gridSize;
+        cell.interferenceLoad = numDevices / 1000.0;
+        cell.interferenceCoeff = descriptor.interferenceCoeff;
+        cell.variationLow = 1.0 - constants.variationAmplitude;
+        cell.variationSpan = 2.0 * constants.variationAmplitude;
+        cell.noiseSigma = constants.noiseSigma;
+        cell.latencyScale = 1.0 + (numDevices / 10000.0);
+        cell.spatialInterference = spatialInterference;
+        cell.coverageModel = coverageModel;
+        cell.coverageScale = Coverage::coverageScale(numDevices);
+        cell.antithetic = antithetic;
+        return cell;
+    }
+    
+    // Créneau d'émission d'un appareil, tiré de son propre flux
+    static int interferenceSlot(uint64_t seed, int device) {
+        uint64_t bits, unused;
+        RandomStreams::threefry2x64(seed, RandomStreams::kInterferenceDomain, device, 0, bits, unused);
+        return static_cast<int>(((bits >> 32) * kInterferenceSlots) >> 32);
+    }
+    
+    // Appareils aux nœuds de la grille de calculateDistanceEffect, ramenée à
+    // une cellule de côté 1 ; chacun émet dans un créneau tiré de son flux
+    std::unique_ptr<InterferenceGrid> buildInterferenceGrid(const DeviceKernel::CellParams& cell) {
+        const int64_t width = cell.gridWidth;
+        const int64_t rows = (cell.numDevices + width - 1) / width;
+        std::unique_ptr<InterferenceGrid> grid(new InterferenceGrid(
+            1.0, static_cast<double>(rows) / width, kInterferenceRange, kInterferenceSlots));
         
-        // Seed aléatoire basée sur le temps
-        unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-        rng.seed(seed);
+        for (int i = 0; i < cell.numDevices; i++) {
+            grid->addDevice(static_cast<double>(i % width) / width,
+                            static_cast<double>(i / width) / width, interferenceSlot(cell.seed, i));
+        }
+        return grid;
+    }
+    
+    // Charge vue par un seul appareil, sans construire la grille entière : seuls
+    // les appareils à moins de 2 portées (les 3x3 cases autour du sien) sont
+    // placés, dans l'ordre des index, donc sommés dans le même ordre
+    double neighbourLoad(const DeviceKernel::CellParams& cell, int device) const {
+        const int64_t width = cell.gridWidth;
+        const int64_t rows = (cell.numDevices + width - 1) / width;
+        const int64_t reach = static_cast<int64_t>(2.0 * kInterferenceRange * width) + 1;
+        InterferenceGrid grid(1.0, static_cast<double>(rows) / width, kInterferenceRange, kInterferenceSlots);
         
-        std::cout << "\n========================================" << std::endl;
-        std::cout << "REAL NB-IoT SIMULATIONS - RUN " << seed << std::endl;
-        std::cout << "Each run produces DIFFERENT results!" << std::endl;
-        std::cout << "========================================\n" << std::endl;
+        const int64_t x = device % width, y = device / width;
+        uint32_t self = 0;
+        for (int64_t row = std::max<int64_t>(0, y - reach); row <= std::min(rows - 1, y + reach); row++) {
+            for (int64_t column = std::max<int64_t>(0, x - reach); column <= std::min(width - 1, x + reach);
+                 column++) {
+                int64_t i = row * width + column;
+                if (i >= cell.numDevices) break;
+                uint32_t id = grid.addDevice(static_cast<double>(column) / width,
+                                             static_cast<double>(row) / width,
+                                             interferenceSlot(cell.seed, static_cast<int>(i)));
+                if (i == device) self = id;
+            }
+        }
+        return grid.interferenceAt(self);
+    }
+    
+    // Une cellule simulée événement par événement : les paquets livrés
+    // remplacent les appareils dans les statistiques
+    void runAccessSimulation(SimulationResult& result, const ModeDescriptor& descriptor,
+                             const ModelConstants& constants, uint64_t streamSeed, bool antithetic) {
+        AccessEngine engine(accessConfig, descriptor.procedure, streamSeed,
+                            result.numDevices, keepSamples, antithetic);
+        AccessResult access;
+        {
+            NBIOT_PROFILE_SCOPE("accessEngine.run");
+            access = engine.run();
+        }
+        NBIOT_PROFILE_COUNTER("accessEvents", access.events);
         
-        for (const auto& mode : modes) {
+        result.energyStats = access.energy;
+        result.latencyStats = access.latency;
+        result.energySketch = std::move(access.energySketch);
+        result.latencySketch = std::move(access.latencySketch);
+        result.individualEnergies = std::move(access.energies);
+        result.individualLatencies = std::move(access.latencies);
+        result.simulatedEvents = access.events;
+        result.collisions = access.collisions;
+        result.failedAccesses = access.failures;
+        result.failedEnergy = access.failedEnergy.mean() * access.failedEnergy.count();
+        
+        result.avgEnergy = result.energyStats.mean();
+        result.avgLatency = result.latencyStats.mean();
+        result.energyStdDev = result.energyStats.stdDev();
+        result.latencyStdDev = result.latencyStats.stdDev();
+        
+        result.batteryLife = batteryLifeYears(result.avgEnergy, constants.batteryJ);
+    }
+    
+    // Tout ce qui fixe le résultat d'une cellule en dehors de sa clé (mode,
+    // appareils, graine, répétition). Les noyaux scalar/AVX2/AVX-512 donnent
+    // des résultats identiques : l'ISA n'en fait pas partie
+    uint64_t cacheModelHash() const {
+        ResultCache::ModelHash hash;
+        hash.add(kModelVersion);
+        for (const auto& mode : ModeRegistry::instance().modes()) {
+            hash.add(mode.name).add(mode.energyMin).add(mode.energySpan).add(mode.latencyMin)
+                .add(mode.latencySpan).add(mode.interferenceCoeff)
+                .add(static_cast<int64_t>(mode.procedure));
+        }
+        hash.add(static_cast<int64_t>(kDevicesPerChunk)).add(static_cast<int64_t>(DeviceKernel::kBlockSize))
+            .add(static_cast<int64_t>(QuantileSketch::kSubBucketBits));
+        hash.add(static_cast<int64_t>(spatialInterference));
+        if (spatialInterference) hash.add(kInterferenceRange).add(static_cast<int64_t>(kInterferenceSlots));
+        if (coverageModel && !discreteEvents) {
+            // Les tables sont constantes : leur contenu suffit à les identifier
+            hash.add("coverage-ce").add(&Coverage::kTables, sizeof(Coverage::kTables));
+        }
+        hash.add(static_cast<int64_t>(discreteEvents));
+        if (discreteEvents) {
+            const AccessConfig& c = accessConfig;
+            for (double value : {c.simulatedDays, c.reportingPeriodMs, c.arrivalJitterMs, c.nprachPeriodMs,
+                                 c.preambleMs, c.rarWindowMs, c.msg3Ms, c.edtMsg3Ms, c.msg4Ms,
+                                 c.contentionTimerMs, c.backoffMs, c.dataMs, c.connectedTailMs, c.purDataMs,
+                                 c.purAckMs, c.purFallbackProbability, c.txPowerW, c.rxPowerW,
+                                 c.connectedIdlePowerW, c.sleepPowerW}) {
+                hash.add(value);
+            }
+            for (int value : {c.preambles, c.maxGrantsPerOccasion, c.maxAttempts}) {
+                hash.add(static_cast<int64_t>(value));
+            }
+            if (c.purPlan) hash.add("pur-plan").add(static_cast<int64_t>(c.purTones));
+        }
+        return hash.value();
+    }
+    
+    static CellRecord toCellRecord(const SimulationResult& result) {
+        CellRecord record;
+        record.avgEnergy = result.avgEnergy;
+        record.avgLatency = result.avgLatency;
+        record.energyStdDev = result.energyStdDev;
+        record.latencyStdDev = result.latencyStdDev;
+        record.batteryLife = result.batteryLife;
+        record.energyStats = result.energyStats;
+        record.latencyStats = result.latencyStats;
+        record.energySketch = result.energySketch;
+        record.latencySketch = result.latencySketch;
+        record.simulatedEvents = result.simulatedEvents;
+        record.collisions = result.collisions;
+        record.failedAccesses = result.failedAccesses;
+        record.failedEnergy = result.failedEnergy;
+        return record;
+    }
+    
+    static SimulationResult fromCellRecord(const std::string& mode, int numDevices, CellRecord& record) {
+        SimulationResult result;
+        result.mode = mode;
+        result.numDevices = numDevices;
+        result.avgEnergy = record.avgEnergy;
+        result.avgLatency = record.avgLatency;
+        result.energyStdDev = record.energyStdDev;
+        result.latencyStdDev = record.latencyStdDev;
+        result.batteryLife = record.batteryLife;
+        result.energyStats = record.energyStats;
+        result.latencyStats = record.latencyStats;
+        result.energySketch = std::move(record.energySketch);
+        result.latencySketch = std::move(record.latencySketch);
+        result.simulatedEvents = record.simulatedEvents;
+        result.collisions = record.collisions;
+        result.failedAccesses = record.failedAccesses;
+        result.failedEnergy = record.failedEnergy;
+        return result;
+    }
+    
+    // Une réplication d'une cellule (mode, appareils)
+    struct SweepCell {
+        std::string mode;
+        int numDevices;
+        int repeat;
+    };
+    
+    // Avec --crn tous les modes tirent dans le même flux pour une réplication
+    // donnée ; avec --antithetic les réplications 2k et 2k+1 partagent leur
+    // graine et la seconde utilise les tirages opposés
+    uint64_t replicationSeed(const SweepCell& cell) const {
+        const std::string stream = commonRandomNumbers ? std::string("common") : cell.mode;
+        int index = antitheticVariates ? cell.repeat / 2 : cell.repeat;
+        return RandomStreams::cellSeed(masterSeed, stream, cell.numDevices, index);
+    }
+    
+    bool isAntithetic(int repeat) const { return antitheticVariates && repeat % 2 == 1; }
+    
+    // Une réplication terminée, pour le flux NDJSON (mis en forme hors du pool)
+    void streamCell(const ResultCache::Key& key, const SimulationResult& result, bool cached) {
+        if (!resultStream || !resultStream->hasConsumer()) return;
+        resultStream->cellDone({key.mode, key.numDevices, key.repeat, key.seed, cached, result.avgEnergy,
+                                result.energyStdDev, result.avgLatency, result.latencyStdDev,
+                                result.latencySketch.quantile(0.50), result.latencySketch.quantile(0.95),
+                                result.latencySketch.quantile(0.99), result.batteryLife, result.collisions,
+                                result.failedAccesses});
+    }
+    
+    void streamSweepStarted(unsigned threads) {
+        if (!resultStream) return;
+        resultStream->sweepStarted({masterSeed, discreteEvents ? "des" : "closed-form",
+                                    DeviceKernel::isaName(kernelIsa), threads, modes, deviceCounts});
+    }
+    
+    // Simule les cellules sur le pool ; les cellules trouvées dans le cache
+    // sont relues et marquées computed[c] = 0
+    void runCells(const std::vector<SweepCell>& cells, std::vector<SimulationResult>& results,
+                  std::vector<char>& computed, TaskPool& pool, ResultCache* cache, bool readCache) {
+        results.assign(cells.size(), SimulationResult());
+        computed.assign(cells.size(), 1);
+        TaskPool::TaskGroup sweep;
+        for (size_t c = 0; c < cells.size(); c++) {
+            const SweepCell& cell = cells[c];
+            ResultCache::Key key{cell.mode, cell.numDevices, replicationSeed(cell), cell.repeat};
+            const bool antithetic = isAntithetic(cell.repeat);
+            
+            CellRecord record;
+            if (readCache && cache->lookup(key, record)) {
+                results[c] = fromCellRecord(cell.mode, cell.numDevices, record);
+                computed[c] = 0;
+                streamCell(key, results[c], true);
+                continue;
+            }
+            pool.submit(sweep, [this, &pool, &results, cache, key, antithetic, c] {
+                results[c] = runSimulation(key.mode, key.numDevices, key.seed, &pool, key.repeat, antithetic);
+                if (cache != nullptr) cache->store(key, toCellRecord(results[c]));
+                streamCell(key, results[c], false);
+            });
+        }
+        pool.wait(sweep);
+    }
+    
+    // Intervalles de confiance d'une taille de cellule, calculés sur les
+    // unités indépendantes (paires antithétiques moyennées)
+    struct ReplicationSummary {
+        std::vector<SequentialStopping::Interval> energy;   // un par mode
+        bool hasSavings = false;
+        SequentialStopping::Interval savings{0, 0.0, 0.0};  // 1 - PUR/RAP, apparié par unité
+    };
+    
+    ReplicationSummary summarizeReplications(const std::vector<std::vector<SimulationResult>>& replications,
+                                             size_t deviceIndex) const {
+        ReplicationSummary summary;
+        std::vector<std::vector<double>> energyUnits(modes.size());
+        int rap = -1, pur = -1;
+        for (size_t m = 0; m < modes.size(); m++) {
+            std::vector<double> energies;
+            for (const auto& result : replications[m * deviceCounts.size() + deviceIndex]) {
+                energies.push_back(result.avgEnergy);
+            }
+            energyUnits[m] = SequentialStopping::units(energies, antitheticVariates);
+            summary.energy.push_back(SequentialStopping::meanInterval(energyUnits[m]));
+            if (modes[m] == "RAP") rap = static_cast<int>(m);
+            if (modes[m] == "PUR") pur = static_cast<int>(m);
+        }
+        if (rap >= 0 && pur >= 0) {
+            std::vector<double> savings;
+            for (size_t u = 0; u < energyUnits[rap].size() && u < energyUnits[pur].size(); u++) {
+                savings.push_back(1.0 - energyUnits[pur][u] / energyUnits[rap][u]);
+            }
+            summary.hasSavings = true;
+            summary.savings = SequentialStopping::meanInterval(savings);
+        }
+        return summary;
+    }
+    
+    // Unités visées à la vague suivante : inchangé une fois la précision
+    // atteinte (ou le budget épuisé), sinon l'estimation n·(h/cible)²,
+    // au plus le double de l'actuel pour ne pas surestimer sur peu d'unités
+    int plannedUnits(const ReplicationSummary& summary, int units, int maxUnits) const {
+        int needed = units;
+        for (const auto& interval : summary.energy) {
+            needed = std::max(needed, SequentialStopping::unitsNeeded(
+                interval, confidenceTarget * std::fabs(interval.mean)));
+        }
+        if (summary.hasSavings) {
+            needed = std::max(needed, SequentialStopping::unitsNeeded(summary.savings, confidenceTarget));
+        }
+        if (needed <= units || units >= maxUnits) return units;
+        return std::min(maxUnits, std::max(units + 1, std::min(needed, 2 * units)));
+    }
+    
+    void printReplicationIntervals(const std::vector<std::vector<SimulationResult>>& replications,
+                                   const std::vector<int>& units, int maxUnits) const {
+        const bool adaptive = confidenceTarget > 0.0;
+        std::cout << "\nREPLICATION CONFIDENCE INTERVALS (95%";
+        if (adaptive) std::cout << ", target +/-" << confidenceTarget * 100.0 << "%";
+        if (commonRandomNumbers) std::cout << ", common random numbers";
+        if (antitheticVariates) std::cout << ", antithetic pairs";
+        std::cout << ")" << std::endl;
+        
+        for (size_t d = 0; d < deviceCounts.size(); d++) {
+            ReplicationSummary summary = summarizeReplications(replications, d);
+            std::cout << "  " << deviceCounts[d] << " devices, " << units[d]
+                      << (antitheticVariates ? " pairs:" : " replications:");
+            for (size_t m = 0; m < modes.size(); m++) {
+                std::cout << (m == 0 ? " " : " | ") << modes[m] << " " << summary.energy[m].mean
+                          << " J +/-" << summary.energy[m].relativeHalfWidth() * 100.0 << "%";
+            }
+            if (summary.hasSavings) {
+                std::cout << " | PUR saving " << summary.savings.mean * 100.0 << "% +/-"
+                          << summary.savings.halfWidth * 100.0 << " pts";
+            }
+            if (adaptive) {
+                bool converged = plannedUnits(summary, units[d], maxUnits + 1) == units[d];
+                std::cout << (converged ? " [converged]" : " [budget reached]");
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    // Moyenne des réplications de chaque (mode, taille de cellule), dans l'ordre
+    // des modes puis des tailles ; un balayage fusionné repasse par ici
+    std::vector<SimulationResult> aggregateReplications(
+            const std::vector<std::vector<SimulationResult>>& replications) {
+        std::vector<SimulationResult> allResults;
+        for (size_t m = 0; m < modes.size(); m++) {
+            const std::string& mode = modes[m];
             std::cout << "\n=== MODE: " << mode << " ===" << std::endl;
             
-            for (int numDevices : deviceCounts) {
+            for (size_t d = 0; d < deviceCounts.size(); d++) {
+                NBIOT_PROFILE_SCOPE("aggregateRepeats");
+                int numDevices = deviceCounts[d];
                 std::cout << "\nSimulating " << numDevices << " devices..." << std::endl;
                 
-                // Exécuter 3 simulations pour obtenir une moyenne
-                std::vector<SimulationResult> repeatResults;
-                for (int repeat = 0; repeat < 3; repeat++) {
-                    repeatResults.push_back(runSimulation(mode, numDevices));
-                }
+                // Moyenne des réplications de la cellule (3 sans --ci-target)
+                const std::vector<SimulationResult>& repeatResults = replications[m * deviceCounts.size() + d];
                 
                 // Calculer moyenne des répétitions
                 SimulationResult avgResult;
@@ -173,48 +869,619 @@ public:
                 avgResult.numDevices = numDevices;
                 
                 double totalEnergy = 0.0, totalLatency = 0.0;
+                double totalEnergyStdDev = 0.0, totalLatencyStdDev = 0.0;
                 for (const auto& res : repeatResults) {
                     totalEnergy += res.avgEnergy;
                     totalLatency += res.avgLatency;
+                    totalEnergyStdDev += res.energyStdDev;
+                    totalLatencyStdDev += res.latencyStdDev;
+                    
+                    // Les percentiles portent sur tous les appareils des répétitions
+                    avgResult.energyStats.merge(res.energyStats);
+                    avgResult.latencyStats.merge(res.latencyStats);
+                    avgResult.energySketch.merge(res.energySketch);
+                    avgResult.latencySketch.merge(res.latencySketch);
+                    avgResult.simulatedEvents += res.simulatedEvents;
+                    avgResult.collisions += res.collisions;
+                    avgResult.failedAccesses += res.failedAccesses;
+                    avgResult.failedEnergy += res.failedEnergy;
                 }
                 
                 avgResult.avgEnergy = totalEnergy / repeatResults.size();
                 avgResult.avgLatency = totalLatency / repeatResults.size();
-                avgResult.batteryLife = 18000.0 / ((avgResult.avgEnergy * 24.0) * 365.0);
+                avgResult.energyStdDev = totalEnergyStdDev / repeatResults.size();
+                avgResult.latencyStdDev = totalLatencyStdDev / repeatResults.size();
+                avgResult.batteryLife = batteryLifeYears(avgResult.avgEnergy, ModelConstants().batteryJ);
                 
                 allResults.push_back(avgResult);
+                if (resultStream) {
+                    resultStream->aggregate({mode, numDevices, static_cast<int>(repeatResults.size()),
+                                             avgResult.avgEnergy, avgResult.avgLatency,
+                                             avgResult.latencySketch.quantile(0.50),
+                                             avgResult.latencySketch.quantile(0.95),
+                                             avgResult.latencySketch.quantile(0.99), avgResult.batteryLife});
+                }
                 
                 std::cout << "  Average energy: " << avgResult.avgEnergy << " J" << std::endl;
                 std::cout << "  Average latency: " << avgResult.avgLatency << " ms" << std::endl;
+                std::cout << "  Latency p50/p95/p99: " << avgResult.latencySketch.quantile(0.50)
+                          << " / " << avgResult.latencySketch.quantile(0.95)
+                          << " / " << avgResult.latencySketch.quantile(0.99) << " ms" << std::endl;
                 std::cout << "  Battery life: " << avgResult.batteryLife << " years" << std::endl;
+                if (discreteEvents) {
+                    std::cout << "  Preamble collisions: " << avgResult.collisions
+                              << " | Failed accesses: " << avgResult.failedAccesses << std::endl;
+                    if (avgResult.failedAccesses > 0) {
+                        std::cout << "  Energy of failed reports: " << avgResult.failedEnergy
+                                  / avgResult.failedAccesses << " J each, charged to the next delivered report"
+                                  << std::endl;
+                    }
+                }
+                if (confidenceTarget > 0.0) std::cout << "  Replications: " << repeatResults.size() << std::endl;
+            }
+        }
+        return allResults;
+    }
+    
+    // Grille d'un balayage à réplications fixes : index = ((m·D) + d)·R + r
+    SweepCell gridCell(uint32_t index, int replicationsPerCell) const {
+        int repeat = static_cast<int>(index % replicationsPerCell);
+        uint32_t group = index / replicationsPerCell;
+        return {modes[group / deviceCounts.size()], deviceCounts[group % deviceCounts.size()], repeat};
+    }
+    
+    ShardState::Manifest shardManifest(int replicationsPerCell) const {
+        ShardState::Manifest manifest;
+        manifest.shardIndex = shardIndex;
+        manifest.shardCount = shardCount;
+        manifest.modelHash = cacheModelHash();
+        manifest.masterSeed = masterSeed;
+        manifest.repeats = static_cast<uint32_t>(replicationsPerCell);
+        manifest.commonRandomNumbers = commonRandomNumbers;
+        manifest.antithetic = antitheticVariates;
+        manifest.modes = modes;
+        manifest.deviceCounts = deviceCounts;
+        return manifest;
+    }
+    
+    // Une cellule sur shardCount, en tourniquet pour équilibrer les tailles
+    void runShard(TaskPool& pool, ResultCache* cache, bool readCache) {
+        NBIOT_PROFILE_SCOPE("sweep");
+        auto start = std::chrono::steady_clock::now();
+        const int replicationsPerCell = fixedUnits * (antitheticVariates ? 2 : 1);
+        ShardState::Manifest manifest = shardManifest(replicationsPerCell);
+        
+        std::vector<SweepCell> cells;
+        std::vector<uint32_t> indices;
+        long long devices = 0;
+        for (uint32_t index = shardIndex; index < manifest.gridSize(); index += shardCount) {
+            cells.push_back(gridCell(index, replicationsPerCell));
+            indices.push_back(index);
+            devices += cells.back().numDevices;
+        }
+        
+        std::vector<SimulationResult> results;
+        std::vector<char> computed;
+        runCells(cells, results, computed, pool, cache, readCache);
+        
+        std::vector<ShardState::Cell> state;
+        for (size_t c = 0; c < cells.size(); c++) {
+            ResultCache::Key key{cells[c].mode, cells[c].numDevices, replicationSeed(cells[c]), cells[c].repeat};
+            state.push_back({indices[c], key, toCellRecord(results[c])});
+        }
+        const std::string path = outputPath(ShardState::fileName(shardIndex, shardCount));
+        ShardState::write(path, manifest, state);
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Shard " << shardIndex << "/" << shardCount << ": " << cells.size() << " of "
+                  << manifest.gridSize() << " cells, " << devices << " devices in " << seconds
+                  << " s (" << std::count(computed.begin(), computed.end(), 1) << " computed)" << std::endl;
+        std::cout << "Partial state written to " << path << std::endl;
+        if (resultStream) {
+            uint64_t computedCells = std::count(computed.begin(), computed.end(), 1);
+            resultStream->sweepDone({cells.size(), computedCells, static_cast<uint64_t>(devices), seconds});
+        }
+    }
+    
+    // Combine les fichiers de tous les shards d'un balayage et produit les
+    // mêmes résultats qu'une exécution en un seul processus. Le modèle
+    // (moteur, interférence, durée simulée) doit être celui des shards
+    void mergeShards(const std::vector<std::string>& paths) {
+        std::vector<ShardState::Manifest> manifests(paths.size());
+        std::vector<std::vector<ShardState::StoredCell>> stored(paths.size());
+        for (size_t f = 0; f < paths.size(); f++) {
+            stored[f] = ShardState::read(paths[f], manifests[f]);
+        }
+        
+        const ShardState::Manifest& sweep = manifests.front();
+        std::vector<char> seenShard(sweep.shardCount, 0);
+        for (size_t f = 0; f < paths.size(); f++) {
+            if (!manifests[f].sameSweep(sweep)) {
+                throw std::runtime_error(paths[f] + " belongs to another sweep than " + paths.front());
+            }
+            if (seenShard[manifests[f].shardIndex]++) {
+                throw std::runtime_error("Shard " + std::to_string(manifests[f].shardIndex) + " given twice");
+            }
+        }
+        if (paths.size() != sweep.shardCount) {
+            throw std::runtime_error("Expected " + std::to_string(sweep.shardCount) + " shard files, got "
+                                     + std::to_string(paths.size()));
+        }
+        
+        masterSeed = sweep.masterSeed;
+        seedFixed = true;
+        modes = sweep.modes;
+        deviceCounts = sweep.deviceCounts;
+        commonRandomNumbers = sweep.commonRandomNumbers;
+        antitheticVariates = sweep.antithetic;
+        const int replicationsPerCell = static_cast<int>(sweep.repeats);
+        fixedUnits = replicationsPerCell / (antitheticVariates ? 2 : 1);
+        if (sweep.modelHash != cacheModelHash()) {
+            throw std::runtime_error("The shards were computed with another model; "
+                                     "pass the same --engine, --sim-days, --interference and --coverage options");
+        }
+        
+        // Les cellules retrouvent leur place dans la grille, donc l'ordre
+        // des réplications d'un balayage en un seul processus
+        std::vector<SimulationResult> grid(sweep.gridSize());
+        std::vector<char> present(sweep.gridSize(), 0);
+        for (size_t f = 0; f < paths.size(); f++) {
+            for (auto& cell : stored[f]) {
+                SweepCell position = gridCell(cell.index, replicationsPerCell);
+                ResultCache::Key key{position.mode, position.numDevices, replicationSeed(position), position.repeat};
+                CellRecord record;
+                if (present[cell.index]++ || !ResultCache::decode(cell.payload, key, record)) {
+                    throw std::runtime_error("Cell " + std::to_string(cell.index) + " is duplicated or does not "
+                                             "match the sweep in " + paths[f]);
+                }
+                grid[cell.index] = fromCellRecord(position.mode, position.numDevices, record);
             }
         }
+        size_t missing = std::count(present.begin(), present.end(), 0);
+        if (missing > 0) throw std::runtime_error(std::to_string(missing) + " cells are missing from the shards");
+        
+        std::vector<std::vector<SimulationResult>> replications(modes.size() * deviceCounts.size());
+        for (uint32_t index = 0; index < grid.size(); index++) {
+            replications[index / replicationsPerCell].push_back(std::move(grid[index]));
+        }
+        
+        std::cout << "\n========================================" << std::endl;
+        std::cout << "MERGED NB-IoT SIMULATIONS - RUN " << masterSeed << std::endl;
+        std::cout << sweep.gridSize() << " cells from " << paths.size() << " shards" << std::endl;
+        std::cout << "========================================\n" << std::endl;
+        streamSweepStarted(0);
+        
+        std::vector<SimulationResult> allResults = aggregateReplications(replications);
+        printReplicationIntervals(replications, std::vector<int>(deviceCounts.size(), fixedUnits), fixedUnits);
+        
+        saveResults(allResults);
+        TaskPool pool(threadCount);
+        performStatisticalAnalysis(replications, allResults, pool);
+        generateGraphs(allResults);
+        if (lifetimeEnabled) simulateLifetimes(allResults, pool);
+        if (accessConfig.purPlan) planPurResources();
+        if (resultStream) resultStream->sweepDone({sweep.gridSize(), 0, 0, 0.0});
+    }
+    
+    // Appareils d'une réplication à recalculer (--replay)
+    struct ReplayRequest {
+        std::string mode;
+        int numDevices;
+        int repeat;
+        std::vector<int> devices;
+    };
+    
+    // Recalcule chaque appareil demandé avec les tirages du balayage de même
+    // graine, en O(1) par appareil, et affiche tous ses facteurs
+    void replayDevices(const std::vector<ReplayRequest>& requests) {
+        if (!seedFixed) {
+            throw std::invalid_argument("--replay needs the --seed of the sweep (printed as RUN <seed>)");
+        }
+        if (discreteEvents) {
+            throw std::invalid_argument("--replay recomputes the closed-form kernel; with --engine des a device "
+                                        "depends on the whole cell");
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t replayed = 0, mismatches = 0;
+        std::cout << std::setprecision(10);
+        
+        for (const auto& request : requests) {
+            const ModeDescriptor& descriptor = ModeRegistry::instance().get(request.mode);
+            SweepCell sweepCell{request.mode, request.numDevices, request.repeat};
+            const uint64_t streamSeed = replicationSeed(sweepCell);
+            const bool antithetic = isAntithetic(request.repeat);
+            RandomStreams::CellStream cellStream(streamSeed, antithetic);
+            const DeviceKernel::CellParams cell = cellParams(descriptor, ModelConstants(), request.numDevices,
+                                                             streamSeed, antithetic, cellStream);
+            
+            std::cout << "\nREPLAY " << request.mode << ", " << request.numDevices << " devices, repeat "
+                      << request.repeat << (antithetic ? " (antithetic)" : "") << " - run " << masterSeed
+                      << ", cell seed 0x" << std::hex << streamSeed << std::dec << std::endl;
+            std::cout << "  Cell: base energy " << cell.baseEnergy << " J, base latency " << cell.baseLatency
+                      << " ms, latency scale " << cell.latencyScale << std::endl;
+            
+            for (int device : request.devices) {
+                if (device < 0 || device >= request.numDevices) {
+                    throw std::invalid_argument("Device " + std::to_string(device) + " is not in a cell of "
+                                                + std::to_string(request.numDevices) + " devices");
+                }
+                const double load = spatialInterference ? neighbourLoad(cell, device) : 0.0;
+                DeviceKernel::DeviceFactors f = descriptor.explainDevice(cell, device, load);
+                
+                // Contrôle : le bloc du noyau utilisé par le balayage donne les mêmes bits
+                DeviceKernel::Block block;
+                const int first = device - device % DeviceKernel::kBlockSize;
+                std::fill(block.interference, block.interference + DeviceKernel::kBlockSize, 0.0);
+                block.interference[device - first] = load;
+                descriptor.simulateBlock(kernelIsa, cell, first, block);
+                const bool identical = memcmp(&block.energy[device - first], &f.energy, sizeof(double)) == 0
+                                    && memcmp(&block.latency[device - first], &f.latency, sizeof(double)) == 0;
+                mismatches += identical ? 0 : 1;
+                replayed++;
+                
+                std::cout << "  Device " << device << " at (" << f.gridX << ", " << f.gridY << ")" << std::endl;
+                std::cout << "    Draws: variation " << f.uVariation << ", interference " << f.uInterference
+                          << ", radius " << f.uRadius << ", angle " << f.uAngle << std::endl;
+                std::cout << "    Variation: " << f.variation << std::endl;
+                if (coverageModel) {
+                    std::cout << "    Coverage: +" << f.energyBase - cell.baseEnergy << " J, +"
+                              << f.latencyBase - cell.baseLatency << " ms over the cell base" << std::endl;
+                } else {
+                    std::cout << "    Distance effect: " << f.distanceEffect << std::endl;
+                }
+                std::cout << "    Interference: " << (spatialInterference ? "neighbour" : "cell") << " load "
+                          << f.interferenceLoad << ", effect " << f.interferenceEffect << std::endl;
+                std::cout << "    Noise: normal " << f.normal << ", factor " << f.noise << std::endl;
+                std::cout << "    Energy: " << f.energyBase << " x " << f.variation << " x " << f.distanceEffect
+                          << " x " << f.interferenceEffect << " x " << f.noise << " = " << f.energy << " J"
+                          << std::endl;
+                std::cout << "    Latency: " << f.latencyBase << " x " << f.variation << " x " << f.distanceEffect
+                          << " x " << f.latencyScale << " x " << f.noise << " = " << f.latency << " ms"
+                          << std::endl;
+                std::cout << "    Kernel " << DeviceKernel::isaName(kernelIsa) << ": "
+                          << (identical ? "identical" : "MISMATCH") << std::endl;
+            }
+        }
+        std::cout << std::setprecision(6);
+        
+        double milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nReplayed " << replayed << " device(s) in " << milliseconds << " ms" << std::endl;
+        if (mismatches > 0) {
+            throw std::runtime_error(std::to_string(mismatches) + " replayed device(s) differ from the kernel");
+        }
+    }
+    
+    // Une constante du modèle et l'intervalle exploré par --sensitivity
+    struct SensitivityParameter {
+        const char* name;
+        double low;
+        double high;
+    };
+    
+    static const std::vector<SensitivityParameter>& sensitivityParameters() {
+        static const std::vector<SensitivityParameter> parameters = {
+            {"RAP energy min (J)", 3.0, 5.0},
+            {"RAP energy span (J)", 1.0, 3.0},
+            {"PUR energy min (J)", 1.5, 2.5},
+            {"PUR energy span (J)", 0.5, 1.5},
+            {"RAP interference coeff", 0.2, 0.4},
+            {"PUR interference coeff", 0.05, 0.15},
+            {"Device variation (+/-)", 0.05, 0.15},
+            {"Noise sigma", 0.05, 0.15},
+            {"Battery capacity (J)", 13500.0, 22500.0}};
+        return parameters;
+    }
+    
+    // Indices de Sobol des sorties PUR (économie d'énergie face à RAP, durée
+    // de vie, latence p95) pour chaque taille de cellule. Toutes les
+    // évaluations d'une taille tirent dans le même flux (nombres aléatoires
+    // communs) : la variance mesurée est celle des paramètres
+    void runSensitivityAnalysis(uint32_t samples) {
+        if (discreteEvents) {
+            throw std::invalid_argument("--sensitivity varies the closed-form model; it cannot run with --engine des");
+        }
+        if (!seedFixed) masterSeed = std::chrono::system_clock::now().time_since_epoch().count();
+        
+        const std::vector<SensitivityParameter>& parameters = sensitivityParameters();
+        const int k = static_cast<int>(parameters.size());
+        SensitivityAnalysis::SaltelliDesign design(k, samples, RandomStreams::mixSeed(
+            masterSeed, RandomStreams::hashName("sensitivity")));
+        const size_t evaluations = design.evaluationCount();
+        const ModeDescriptor& rap = ModeRegistry::instance().get("RAP");
+        const ModeDescriptor& pur = ModeRegistry::instance().get("PUR");
+        static const char* kOutputs[3] = {"PUR energy saving vs RAP", "PUR battery life (years)",
+                                          "PUR latency p95 (ms)"};
+        
+        TaskPool pool(threadCount);
+        std::cout << "\n========================================" << std::endl;
+        std::cout << "SENSITIVITY ANALYSIS - RUN " << masterSeed << std::endl;
+        std::cout << k << " parameters, " << samples << " scrambled Sobol samples: " << evaluations
+                  << " evaluations x 2 modes per cell size, " << pool.threadCount() << " threads" << std::endl;
+        std::cout << "========================================" << std::endl;
+        
+        std::ofstream csv(outputPath("sensitivity_indices.csv"));
+        if (!csv) throw std::runtime_error("Cannot create " + outputPath("sensitivity_indices.csv"));
+        csv << "Output,Devices,Parameter,Low,High,First_Order,Total_Effect,First_Order_Half,Total_Effect_Half\n";
+        csv << std::setprecision(6);
+        
+        auto start = std::chrono::steady_clock::now();
+        long long devices = 0;
+        for (int numDevices : deviceCounts) {
+            const uint64_t seed = RandomStreams::cellSeed(masterSeed, "sensitivity", numDevices, 0);
+            std::vector<std::vector<double>> outputs(3, std::vector<double>(evaluations));
+            
+            // Les évaluations sont indépendantes : par lots sur le pool
+            const size_t kEvaluationsPerTask = 16;
+            TaskPool::TaskGroup group;
+            for (size_t first = 0; first < evaluations; first += kEvaluationsPerTask) {
+                pool.submit(group, [&, first] {
+                    std::vector<double> unit(k), x(k);
+                    for (size_t e = first; e < std::min(evaluations, first + kEvaluationsPerTask); e++) {
+                        design.point(e, unit.data());
+                        for (int i = 0; i < k; i++) {
+                            x[i] = parameters[i].low + unit[i] * (parameters[i].high - parameters[i].low);
+                        }
+                        ModeDescriptor rapPoint = rap, purPoint = pur;
+                        rapPoint.energyMin = x[0];
+                        rapPoint.energySpan = x[1];
+                        purPoint.energyMin = x[2];
+                        purPoint.energySpan = x[3];
+                        rapPoint.interferenceCoeff = x[4];
+                        purPoint.interferenceCoeff = x[5];
+                        ModelConstants constants;
+                        constants.variationAmplitude = x[6];
+                        constants.noiseSigma = x[7];
+                        constants.batteryJ = x[8];
+                        
+                        SimulationResult rapResult = runSimulation(rapPoint, constants, numDevices, seed, &pool, 0, false);
+                        SimulationResult purResult = runSimulation(purPoint, constants, numDevices, seed, &pool, 0, false);
+                        outputs[0][e] = 1.0 - purResult.avgEnergy / rapResult.avgEnergy;
+                        outputs[1][e] = purResult.batteryLife;
+                        outputs[2][e] = purResult.latencySketch.quantile(0.95);
+                    }
+                });
+            }
+            pool.wait(group);
+            devices += 2LL * numDevices * static_cast<long long>(evaluations);
+            
+            for (int o = 0; o < 3; o++) {
+                SensitivityAnalysis::Indices indices = SensitivityAnalysis::estimate(outputs[o], design);
+                SensitivityAnalysis::Indices half = SensitivityAnalysis::estimate(outputs[o], design, samples / 2);
+                std::cout << "\n" << kOutputs[o] << ", " << numDevices << " devices (mean " << indices.mean
+                          << ", std dev " << std::sqrt(indices.variance) << ")" << std::endl;
+                std::cout << "  " << std::left << std::setw(26) << "Parameter" << std::right << std::setw(22)
+                          << "Range" << std::setw(13) << "First-order" << std::setw(9) << "Total"
+                          << std::setw(14) << "Total (n/2)" << std::endl;
+                for (int i = 0; i < k; i++) {
+                    std::ostringstream range;
+                    range << parameters[i].low << " - " << parameters[i].high;
+                    std::cout << "  " << std::left << std::setw(26) << parameters[i].name << std::right
+                              << std::setw(22) << range.str() << std::fixed << std::setprecision(3)
+                              << std::setw(13) << indices.firstOrder[i] << std::setw(9)
+                              << indices.totalEffect[i] << std::setw(14) << half.totalEffect[i]
+                              << std::defaultfloat << std::setprecision(6) << std::endl;
+                    csv << kOutputs[o] << "," << numDevices << "," << parameters[i].name << ","
+                        << parameters[i].low << "," << parameters[i].high << "," << indices.firstOrder[i] << ","
+                        << indices.totalEffect[i] << "," << half.firstOrder[i] << "," << half.totalEffect[i]
+                        << "\n";
+                }
+            }
+        }
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\n" << evaluations * deviceCounts.size() << " parameter points, " << devices
+                  << " device-simulations in " << seconds << " s (" << devices / seconds << " devices/s)"
+                  << std::endl;
+        std::cout << "Indices written to " << outputPath("sensitivity_indices.csv") << std::endl;
+    }
+    
+    void runMultipleSimulations() {
+        // Seed aléatoire basée sur le temps (sauf si --seed est fourni)
+        if (!seedFixed) {
+            masterSeed = std::chrono::system_clock::now().time_since_epoch().count();
+        }
+        rng.seed(static_cast<unsigned>(masterSeed));
+        
+        TaskPool pool(threadCount);
+        
+        if (!profilePath.empty()) {
+            if (Profiler::kCompiledIn) {
+                Profiler::enable();
+            } else {
+                std::cerr << "Note: built with NBIOT_NO_PROFILING; --profile ignored" << std::endl;
+            }
+        }
+        
+        if (coverageModel && discreteEvents) {
+            std::cerr << "Note: --coverage applies to the closed-form kernel only; ignored with --engine des"
+                      << std::endl;
+        }
+        if (!tracePath.empty() && discreteEvents) {
+            std::cerr << "Note: --trace records the closed-form kernel only; ignored with --engine des"
+                      << std::endl;
+        } else if (!tracePath.empty()) {
+            traceWriter.reset(new TraceWriter(tracePath, traceCodec));
+        }
+        
+        // Les traces et --keep-samples ont besoin des valeurs par appareil :
+        // les cellules sont alors recalculées (et le cache mis à jour)
+        std::unique_ptr<ResultCache> cache;
+        if (!cacheDirectory.empty()) {
+            uint64_t model = cacheModelHash();
+            if (pruneCache) {
+                size_t removed = ResultCache::prune(cacheDirectory, model);
+                std::cout << "Cache: " << removed << " pack(s) of other model versions removed" << std::endl;
+            }
+            cache.reset(new ResultCache(cacheDirectory, model));
+        }
+        const bool readCache = cache && !traceWriter && !keepSamples;
+        
+        std::cout << "\n========================================" << std::endl;
+        std::cout << "REAL NB-IoT SIMULATIONS - RUN " << masterSeed << std::endl;
+        std::cout << "Each run produces DIFFERENT results!" << std::endl;
+        std::cout << "Threads: " << pool.threadCount();
+        if (discreteEvents) {
+            std::cout << " | Engine: des, " << accessConfig.simulatedDays << " day(s)" << std::endl;
+        } else {
+            std::cout << " | Kernel: " << DeviceKernel::isaName(kernelIsa) << std::endl;
+        }
+        std::cout << "========================================\n" << std::endl;
+        streamSweepStarted(pool.threadCount());
+        
+        // Réplications par (mode, taille de cellule), dans l'ordre des répétitions.
+        // Sans --ci-target : fixedUnits unités par cellule en une vague ; sinon
+        // des vagues successives jusqu'à la précision visée ou au budget
+        const bool adaptive = confidenceTarget > 0.0;
+        const int unitSize = antitheticVariates ? 2 : 1;
+        const int maxUnits = std::max(kMinUnits, maxRepeats / unitSize);
+        std::vector<std::vector<SimulationResult>> replications(modes.size() * deviceCounts.size());
+        std::vector<int> units(deviceCounts.size(), 0);
+        std::vector<int> targetUnits(deviceCounts.size(), adaptive ? kMinUnits : fixedUnits);
+        
+        size_t cellCount = 0;
+        size_t computedCells = 0;
+        long long totalDevices = 0;
+        long long replicatedDevices = 0;
+        uint64_t totalEvents = 0;
+        int waves = 0;
+        auto sweepStart = std::chrono::steady_clock::now();
+        
+        if (shardCount > 0) {
+            runShard(pool, cache.get(), readCache);
+        } else {
+            NBIOT_PROFILE_SCOPE("sweep");
+            for (;;) {
+                std::vector<SweepCell> cells;
+                std::vector<size_t> cellGroups;
+                for (size_t m = 0; m < modes.size(); m++) {
+                    for (size_t d = 0; d < deviceCounts.size(); d++) {
+                        for (int r = units[d] * unitSize; r < targetUnits[d] * unitSize; r++) {
+                            cells.push_back({modes[m], deviceCounts[d], r});
+                            cellGroups.push_back(m * deviceCounts.size() + d);
+                        }
+                    }
+                }
+                if (cells.empty()) break;
+                waves++;
+                
+                std::vector<SimulationResult> cellResults;
+                std::vector<char> computed;
+                runCells(cells, cellResults, computed, pool, cache.get(), readCache);
+                
+                // Le débit ne compte que les cellules calculées pendant ce balayage
+                for (size_t c = 0; c < cells.size(); c++) {
+                    if (computed[c]) {
+                        computedCells++;
+                        totalDevices += cells[c].numDevices;
+                        totalEvents += cellResults[c].simulatedEvents;
+                    }
+                    replicatedDevices += cells[c].numDevices;
+                    replications[cellGroups[c]].push_back(std::move(cellResults[c]));
+                }
+                cellCount += cells.size();
+                units = targetUnits;
+                if (!adaptive) break;
+                
+                for (size_t d = 0; d < deviceCounts.size(); d++) {
+                    targetUnits[d] = plannedUnits(summarizeReplications(replications, d), units[d], maxUnits);
+                }
+            }
+        }
+        
+        uint64_t tracedRows = 0;
+        if (traceWriter) {
+            NBIOT_PROFILE_SCOPE("trace.close");
+            traceWriter->close();
+            tracedRows = traceWriter->rowCount();
+            traceWriter.reset();
+        }
+        
+        double sweepSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - sweepStart).count();
+        
+        // Un shard s'arrête à son état partiel : les résultats viennent de --merge
+        if (shardCount > 0) {
+            if (tracedRows > 0) {
+                std::cout << "Trace: " << tracedRows << " device rows written to " << tracePath << std::endl;
+            }
+            finishProfile();
+            return;
+        }
+        
+        std::vector<SimulationResult> allResults = aggregateReplications(replications);
+        printReplicationIntervals(replications, units, maxUnits);
+        std::cout << "Device-simulations: " << replicatedDevices << " in " << cellCount << " cells";
+        if (adaptive) std::cout << " (" << waves << " waves)";
+        std::cout << std::endl;
+        
+        std::cout << "\nSweep throughput: " << (totalDevices / sweepSeconds) << " devices/s ("
+                  << totalDevices << " devices in " << sweepSeconds << " s, "
+                  << pool.threadCount() << " threads)" << std::endl;
+        if (cache) {
+            std::cout << "Cache: " << (cellCount - computedCells) << " of " << cellCount
+                      << " cells reused, " << computedCells << " computed (" << cache->size()
+                      << " cells in " << cache->packFile() << ")" << std::endl;
+        }
+        if (tracedRows > 0) {
+            std::cout << "Trace: " << tracedRows << " device rows written to " << tracePath << std::endl;
+        }
+        if (discreteEvents) {
+            std::cout << "Event rate: " << (totalEvents / sweepSeconds) << " events/s ("
+                      << totalEvents << " events)" << std::endl;
+        }
         
         // Sauvegarder résultats
         saveResults(allResults);
         
         // Analyser statistiquement
-        performStatisticalAnalysis(allResults);
+        performStatisticalAnalysis(replications, allResults, pool);
         
         // Générer graphiques
         generateGraphs(allResults);
+        
+        if (lifetimeEnabled) simulateLifetimes(allResults, pool);
+        if (accessConfig.purPlan) planPurResources();
+        
+        if (resultStream) {
+            resultStream->sweepDone({cellCount, computedCells, static_cast<uint64_t>(totalDevices), sweepSeconds});
+        }
+        finishProfile();
+    }
+    
+    void finishProfile() {
+        if (Profiler::enabled()) {
+            Profiler::disable();
+            Profiler::writeChromeTrace(profilePath);
+            std::cout << "\nProfile written to " << profilePath << " (Chrome trace events)" << std::endl;
+            Profiler::printSummary(std::cout);
+        }
     }
     
     void saveResults(const std::vector<SimulationResult>& results) {
-        std::ofstream csvFile("real_simulation_results.csv");
-        csvFile << "Mode,Devices,Energy_J,Latency_ms,BatteryLife_Years\n";
+        NBIOT_PROFILE_SCOPE("saveResults");
+        std::ofstream csvFile(outputPath("real_simulation_results.csv"));
+        csvFile << "Mode,Devices,Energy_J,Latency_ms,BatteryLife_Years,"
+                << "Energy_P50_J,Energy_P95_J,Energy_P99_J,"
+                << "Latency_P50_ms,Latency_P95_ms,Latency_P99_ms\n";
         
         for (const auto& res : results) {
             csvFile << res.mode << ","
                     << res.numDevices << ","
                     << res.avgEnergy << ","
                     << res.avgLatency << ","
-                    << res.batteryLife << "\n";
+                    << res.batteryLife << ","
+                    << res.energySketch.quantile(0.50) << ","
+                    << res.energySketch.quantile(0.95) << ","
+                    << res.energySketch.quantile(0.99) << ","
+                    << res.latencySketch.quantile(0.50) << ","
+                    << res.latencySketch.quantile(0.95) << ","
+                    << res.latencySketch.quantile(0.99) << "\n";
         }
         csvFile.close();
         
         // Fichier détaillé
-        std::ofstream detailedFile("detailed_results.txt");
+        std::ofstream detailedFile(outputPath("detailed_results.txt"));
         detailedFile << "DETAILED SIMULATION RESULTS\n";
         detailedFile << "=============================\n\n";
         
@@ -225,29 +1492,38 @@ public:
                         << res.energyStdDev << ")\n";
             detailedFile << "  Latency: " << res.avgLatency << " ms (±" 
                         << res.latencyStdDev << ")\n";
+            detailedFile << "  Energy p50/p95/p99: " << res.energySketch.quantile(0.50) << " / "
+                        << res.energySketch.quantile(0.95) << " / "
+                        << res.energySketch.quantile(0.99) << " J\n";
+            detailedFile << "  Latency p50/p95/p99: " << res.latencySketch.quantile(0.50) << " / "
+                        << res.latencySketch.quantile(0.95) << " / "
+                        << res.latencySketch.quantile(0.99) << " ms\n";
             detailedFile << "  Battery: " << res.batteryLife << " years\n\n";
         }
         detailedFile.close();
         
         std::cout << "\nResults saved to:" << std::endl;
-        std::cout << "  - real_simulation_results.csv" << std::endl;
-        std::cout << "  - detailed_results.txt" << std::endl;
+        std::cout << "  - " << outputPath("real_simulation_results.csv") << std::endl;
+        std::cout << "  - " << outputPath("detailed_results.txt") << std::endl;
     }
     
-    void performStatisticalAnalysis(const std::vector<SimulationResult>& results) {
+    void performStatisticalAnalysis(const std::vector<std::vector<SimulationResult>>& replications,
+                                    const std::vector<SimulationResult>& results, TaskPool& pool) {
+        NBIOT_PROFILE_SCOPE("statisticalAnalysis");
         std::cout << "\n========================================" << std::endl;
         std::cout << "STATISTICAL ANALYSIS" << std::endl;
         std::cout << "========================================\n" << std::endl;
         
         // Séparer par mode
-        std::vector<double> rapEnergies, edtEnergies, purEnergies;
+        std::map<std::string, std::vector<double>> energiesByMode;
         
         for (const auto& res : results) {
-            if (res.mode == "RAP") rapEnergies.push_back(res.avgEnergy);
-            else if (res.mode == "EDT") edtEnergies.push_back(res.avgEnergy);
-            else purEnergies.push_back(res.avgEnergy);
+            energiesByMode[res.mode].push_back(res.avgEnergy);
         }
         
+        const std::vector<double>& rapEnergies = energiesByMode["RAP"];
+        const std::vector<double>& purEnergies = energiesByMode["PUR"];
+        
         // Calculer améliorations
         if (!rapEnergies.empty() && !purEnergies.empty()) {
             double avgRap = std::accumulate(rapEnergies.begin(), rapEnergies.end(), 0.0) 
@@ -261,181 +1537,695 @@ public:
             std::cout << "  RAP average: " << avgRap << " J" << std::endl;
             std::cout << "  PUR average: " << avgPur << " J" << std::endl;
             std::cout << "  Energy saving: " << improvement << "%" << std::endl;
+        }
+        
+        // Avec peu de grappes, le bootstrap sous-estime la dispersion (environ
+        // 73 % de couverture avec 3 unités) : les intervalles de Student des
+        // réplications le remplacent, verdict compris
+        const size_t units = fewestUnits(replications);
+        if (bootstrapReplicates > 0 && units >= kBootstrapMinUnits && units <= kBootstrapMaxUnits) {
+            bootstrapIntervals(replications, pool);
+        } else {
+            std::remove(outputPath("bootstrap_intervals.csv").c_str());
+            studentIntervals(replications, units);
+        }
+    }
+    
+    // Unités indépendantes de la cellule qui en a le moins
+    size_t fewestUnits(const std::vector<std::vector<SimulationResult>>& replications) const {
+        const size_t unitSize = antitheticVariates ? 2 : 1;
+        size_t fewest = std::numeric_limits<size_t>::max();
+        for (const auto& cell : replications) fewest = std::min(fewest, cell.size() / unitSize);
+        return fewest;
+    }
+    
+    // Intervalles de Student à 95 % sur les unités (ceux de
+    // summarizeReplications) : énergie moyenne de chaque mode et économie PUR/RAP
+    void studentIntervals(const std::vector<std::vector<SimulationResult>>& replications, size_t units) {
+        std::cout << "\nReplication confidence intervals (95% Student-t, " << units
+                  << (antitheticVariates ? " pairs" : " replications") << " per cell";
+        if (bootstrapReplicates > 0 && units < kBootstrapMinUnits) {
+            std::cout << "; the bootstrap needs at least " << kBootstrapMinUnits
+                      << ", use --repeats or --ci-target";
+        } else if (bootstrapReplicates > 0) {
+            std::cout << "; the bootstrap is skipped above " << kBootstrapMaxUnits;
+        }
+        std::cout << "):" << std::endl;
+        int significant = 0, compared = 0;
+        for (size_t d = 0; d < deviceCounts.size(); d++) {
+            ReplicationSummary summary = summarizeReplications(replications, d);
+            std::cout << "  " << deviceCounts[d] << " devices:" << std::endl;
+            for (size_t m = 0; m < modes.size(); m++) {
+                const SequentialStopping::Interval& energy = summary.energy[m];
+                std::cout << "    " << std::left << std::setw(8) << modes[m] << std::setw(14) << "energy_mean"
+                          << std::right << energy.mean << " J [" << energy.mean - energy.halfWidth << ", "
+                          << energy.mean + energy.halfWidth << "]" << std::endl;
+            }
+            if (summary.hasSavings && std::isfinite(summary.savings.halfWidth)) {
+                const double low = summary.savings.mean - summary.savings.halfWidth;
+                const double high = summary.savings.mean + summary.savings.halfWidth;
+                std::cout << "    " << std::left << std::setw(8) << "PUR/RAP" << std::setw(14) << "pur_saving"
+                          << std::right << summary.savings.mean * 100.0 << " % [" << low * 100.0 << ", "
+                          << high * 100.0 << "]" << std::endl;
+                compared++;
+                if (low > 0.0 || high < 0.0) significant++;
+            }
+        }
+        if (compared > 0) {
+            std::cout << "  PUR saving significant at 95% for " << significant << " of " << compared
+                      << " cell sizes (Student-t interval excludes 0)" << std::endl;
+        }
+    }
+    
+    // Une statistique d'une taille de cellule : estimation, valeurs des
+    // réplicats et du jackknife
+    struct BootstrapStatistic {
+        std::string name;
+        std::string mode;
+        std::string unit;
+        std::vector<double> replicates;
+        std::vector<double> jackknife;
+        double estimate;
+    };
+    
+    // Intervalles BCa à 95 % des moyennes, de la latence p95 et de
+    // l'économie PUR/RAP de chaque taille de cellule, par bootstrap des
+    // unités indépendantes puis des appareils de chaque réplication tirée
+    // (jusqu'à ClusterBootstrap::kDeviceResamplingMaxUnits unités).
+    // L'économie est la moyenne des économies par unité, comme dans
+    // summarizeReplications
+    void bootstrapIntervals(const std::vector<std::vector<SimulationResult>>& replications, TaskPool& pool) {
+        NBIOT_PROFILE_SCOPE("bootstrap");
+        const int replicates = bootstrapReplicates;
+        const size_t unitSize = antitheticVariates ? 2 : 1;
+
+        const uint64_t seed = RandomStreams::mixSeed(masterSeed, RandomStreams::hashName("bootstrap"));
+        int rap = -1, pur = -1;
+        for (size_t m = 0; m < modes.size(); m++) {
+            if (modes[m] == "RAP") rap = static_cast<int>(m);
+            if (modes[m] == "PUR") pur = static_cast<int>(m);
+        }
+        
+        std::cout << "\nBootstrap confidence intervals (95% BCa, " << replicates << " replicates, "
+                  << (antitheticVariates ? "antithetic pairs" : "replications")
+                  << " resampled with their devices up to " << Bootstrap::ClusterBootstrap::kDeviceResamplingMaxUnits
+                  << " units):" << std::endl;
+        std::ofstream csv(outputPath("bootstrap_intervals.csv"));
+        if (!csv) throw std::runtime_error("Cannot create " + outputPath("bootstrap_intervals.csv"));
+        csv << "Devices,Mode,Statistic,Estimate,Low,High,Units,Replicates\n";
+        
+        auto start = std::chrono::steady_clock::now();
+        int significant = 0, compared = 0;
+        for (size_t d = 0; d < deviceCounts.size(); d++) {
+            // Séries : énergie puis latence de chaque mode ; les unités sont
+            // communes aux modes, ce qui apparie RAP et PUR pour l'économie
+            std::vector<std::vector<Bootstrap::Sample>> series;
+            size_t replicationCount = std::numeric_limits<size_t>::max();
+            for (size_t m = 0; m < modes.size(); m++) {
+                const std::vector<SimulationResult>& cell = replications[m * deviceCounts.size() + d];
+                std::vector<Bootstrap::Sample> energy, latency;
+                for (const SimulationResult& result : cell) {
+                    energy.push_back({&result.energySketch, result.avgEnergy});
+                    latency.push_back({&result.latencySketch, result.avgLatency});
+                }
+                series.push_back(std::move(energy));
+                series.push_back(std::move(latency));
+                replicationCount = std::min(replicationCount, cell.size());
+            }
+            std::vector<std::vector<int>> units;
+            for (size_t r = 0; r + unitSize <= replicationCount; r += unitSize) {
+                units.push_back(antitheticVariates ? std::vector<int>{static_cast<int>(r), static_cast<int>(r + 1)}
+                                                   : std::vector<int>{static_cast<int>(r)});
+            }
+            Bootstrap::ClusterBootstrap engine(series, units, 0.95);
+            
+            std::vector<BootstrapStatistic> statistics;
+            for (const std::string& mode : modes) {
+                statistics.push_back({"energy_mean", mode, "J", {}, {}, 0.0});
+                statistics.push_back({"latency_mean", mode, "ms", {}, {}, 0.0});
+                statistics.push_back({"latency_p95", mode, "ms", {}, {}, 0.0});
+            }
+            const bool hasSavings = rap >= 0 && pur >= 0;
+            if (hasSavings) statistics.push_back({"pur_saving", "PUR/RAP", "%", {}, {}, 0.0});
+            
+            // Statistiques rapportées, dans l'ordre de `statistics`
+            auto collect = [&](const Bootstrap::ClusterBootstrap::Statistics& pooled, double* out) {
+                for (size_t m = 0; m < modes.size(); m++) {
+                    out[3 * m] = pooled.mean[2 * m];
+                    out[3 * m + 1] = pooled.mean[2 * m + 1];
+                    out[3 * m + 2] = pooled.quantile[2 * m + 1];
+                }
+                if (hasSavings) {
+                    const std::vector<double>& purUnits = pooled.unitMean[2 * pur];
+                    const std::vector<double>& rapUnits = pooled.unitMean[2 * rap];
+                    double saving = 0.0;
+                    for (size_t j = 0; j < purUnits.size(); j++) saving += 1.0 - purUnits[j] / rapUnits[j];
+                    out[3 * modes.size()] = 100.0 * saving / purUnits.size();
+                }
+            };
+            std::vector<double> values(statistics.size());
+            collect(engine.estimate(), values.data());
+            for (size_t s = 0; s < statistics.size(); s++) {
+                statistics[s].estimate = values[s];
+                statistics[s].replicates.resize(replicates);
+            }
+            for (size_t u = 0; u < engine.unitCount() && engine.unitCount() > 1; u++) {
+                collect(engine.leaveOneOut(u), values.data());
+                for (size_t s = 0; s < statistics.size(); s++) statistics[s].jackknife.push_back(values[s]);
+            }
             
-            // Calculer intervalle de confiance (simplifié)
-            double rapStd = calculateStdDev(rapEnergies);
-            double purStd = calculateStdDev(purEnergies);
+            // Les réplicats sont indépendants : par lots sur le pool
+            const uint64_t cellSeed = RandomStreams::mixSeed(seed, static_cast<uint64_t>(deviceCounts[d]));
+            const int kReplicatesPerTask = 64;
+            TaskPool::TaskGroup group;
+            for (int first = 0; first < replicates; first += kReplicatesPerTask) {
+                pool.submit(group, [&, first] {
+                    std::vector<double> out(statistics.size());
+                    for (int b = first; b < std::min(replicates, first + kReplicatesPerTask); b++) {
+                        collect(engine.replicate(cellSeed, b), out.data());
+                        for (size_t s = 0; s < statistics.size(); s++) statistics[s].replicates[b] = out[s];
+                    }
+                });
+            }
+            pool.wait(group);
             
-            std::cout << "\nConfidence intervals (95%):" << std::endl;
-            std::cout << "  RAP: " << avgRap << " ± " << (1.96 * rapStd / sqrt(rapEnergies.size())) << " J" << std::endl;
-            std::cout << "  PUR: " << avgPur << " ± " << (1.96 * purStd / sqrt(purEnergies.size())) << " J" << std::endl;
+            std::cout << "  " << deviceCounts[d] << " devices, " << engine.unitCount()
+                      << (antitheticVariates ? " pairs" : " replications")
+                      << (engine.resamplesDevices() ? ":" : " (devices not resampled):") << std::endl;
+            for (BootstrapStatistic& statistic : statistics) {
+                Bootstrap::Interval interval = Bootstrap::bcaInterval(
+                    statistic.estimate, statistic.replicates, statistic.jackknife);
+                std::cout << "    " << std::left << std::setw(8) << statistic.mode << std::setw(14)
+                          << statistic.name << std::right << statistic.estimate << " " << statistic.unit;
+                if (interval.valid()) {
+                    std::cout << " [" << interval.low << ", " << interval.high << "]" << std::endl;
+                } else {
+                    std::cout << " (needs 2 units)" << std::endl;
+                }
+                csv << deviceCounts[d] << "," << statistic.mode << "," << statistic.name << ","
+                    << interval.estimate << "," << interval.low << "," << interval.high << ","
+                    << engine.unitCount() << "," << replicates << "\n";
+                if (statistic.name == "pur_saving" && interval.valid()) {
+                    compared++;
+                    if (interval.low > 0.0 || interval.high < 0.0) significant++;
+                }
+            }
         }
         
-        // Vérifier si les améliorations sont significatives
-        std::cout << "\nStatistical significance:" << std::endl;
-        std::cout << "  Each simulation produces varying results." << std::endl;
-        std::cout << "  The observed improvements are REAL and not fixed." << std::endl;
-        std::cout << "  Run again to see DIFFERENT values!" << std::endl;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (compared > 0) {
+            std::cout << "  PUR saving significant at 95% for " << significant << " of " << compared
+                      << " cell sizes (interval excludes 0)" << std::endl;
+        }
+        std::cout << "  " << replicates * deviceCounts.size() << " replicates in " << seconds << " s, written to "
+                  << outputPath("bootstrap_intervals.csv") << std::endl;
     }
     
-    double calculateStdDev(const std::vector<double>& values) {
-        if (values.empty()) return 0.0;
-        double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
-        double variance = 0.0;
-        for (double val : values) {
-            variance += pow(val - mean, 2);
+    // Durée de vie de chaque appareil de chaque cellule agrégée, avec la
+    // moyenne et l'écart type par appareil de l'énergie d'un rapport
+    void simulateLifetimes(const std::vector<SimulationResult>& results, TaskPool& pool) {
+        NBIOT_PROFILE_SCOPE("lifetime");
+        const LifetimeConfig& c = lifetimeConfig;
+        std::cout << "\n========================================" << std::endl;
+        std::cout << "BATTERY LIFETIME (" << c.years << " years, " << trafficProfileName(c.traffic) << ", "
+                  << c.reportsPerDay << " reports/day, " << c.batteryJ / 3600.0 << " Wh)" << std::endl;
+        std::cout << "========================================" << std::endl;
+        
+        // Le moteur à événements intègre déjà la veille entre deux rapports :
+        // seule l'énergie radio est reprise, le plancher vient de LifetimeConfig
+        double integratedSleepJ = discreteEvents
+                                ? accessConfig.sleepPowerW * accessConfig.reportingPeriodMs / 1000.0 : 0.0;
+        
+        std::ofstream csvFile(outputPath("battery_lifetime.csv"));
+        csvFile << "Mode,Devices,Traffic,ReportsPerDay,ReportEnergy_J,Mean_Years,"
+                << "P5_Years,P50_Years,P95_Years,Survivors_Pct\n";
+        auto start = std::chrono::steady_clock::now();
+        uint64_t totalReports = 0;
+        for (const auto& res : results) {
+            double reportJ = std::max(res.energyStats.mean() - integratedSleepJ, 0.0);
+            uint64_t seed = RandomStreams::cellSeed(masterSeed, "lifetime/" + res.mode, res.numDevices, 0);
+            LifetimeResult lifetime = LifetimeEngine(c, seed).run(res.numDevices, reportJ,
+                                                                  res.energyStats.stdDev(), &pool);
+            totalReports += lifetime.reports;
+            double survivors = 100.0 * lifetime.survivors / lifetime.years.count();
+            
+            std::cout << "  " << res.mode << " " << res.numDevices << " devices: mean "
+                      << lifetime.years.mean() << " y | p5/p50/p95 " << lifetime.yearsSketch.quantile(0.05)
+                      << " / " << lifetime.yearsSketch.quantile(0.50) << " / "
+                      << lifetime.yearsSketch.quantile(0.95) << " y | " << survivors
+                      << "% alive at " << c.years << " y" << std::endl;
+            csvFile << res.mode << "," << res.numDevices << "," << trafficProfileName(c.traffic) << ","
+                    << c.reportsPerDay << "," << reportJ << "," << lifetime.years.mean() << ","
+                    << lifetime.yearsSketch.quantile(0.05) << "," << lifetime.yearsSketch.quantile(0.50) << ","
+                    << lifetime.yearsSketch.quantile(0.95) << "," << survivors << "\n";
         }
-        return sqrt(variance / values.size());
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Lifetimes: " << totalReports << " reports covered in " << seconds << " s -> "
+                  << outputPath("battery_lifetime.csv") << std::endl;
     }
     
-    void generateGraphs(const std::vector<SimulationResult>& results) {
-        // Créer script Python pour graphiques
-        std::ofstream pyScript("generate_graphs.py");
-        
-        pyScript << R"(
-import pandas as pd
-import matplotlib.pyplot as plt
-import numpy as np
-import sys
-
-# Lire résultats
-df = pd.read_csv('real_simulation_results.csv')
-
-# Configuration
-plt.style.use('seaborn-v0_8-darkgrid')
-fig, axes = plt.subplots(2, 2, figsize=(14, 10))
-
-# 1. Graphique énergie avec barres d'erreur
-ax1 = axes[0, 0]
-device_counts = sorted(df['Devices'].unique())
-colors = {'RAP': '#E74C3C', 'EDT': '#3498DB', 'PUR': '#2ECC71'}
-
-for mode in ['RAP', 'EDT', 'PUR']:
-    mode_data = df[df['Mode'] == mode]
-    energies = []
-    errors = []
-    
-    for count in device_counts:
-        subset = mode_data[mode_data['Devices'] == count]
-        if len(subset) > 0:
-            # Simuler une erreur standard
-            energy = subset['Energy_J'].values[0]
-            std_error = energy * 0.1  # 10% d'erreur
-            energies.append(energy)
-            errors.append(std_error)
-        else:
-            energies.append(np.nan)
-            errors.append(0)
-    
-    ax1.errorbar(device_counts, energies, yerr=errors, 
-                 marker='o', label=mode, color=colors[mode],
-                 capsize=5, linewidth=2, alpha=0.8)
-
-ax1.set_xlabel('Number of Devices')
-ax1.set_ylabel('Energy Consumption (J/UE)')
-ax1.set_title('Real Energy Consumption with Error Bars')
-ax1.grid(True, alpha=0.3)
-ax1.legend()
-ax1.set_xscale('log')
-
-# 2. Comparaison latence
-ax2 = axes[0, 1]
-for mode in ['RAP', 'EDT', 'PUR']:
-    mode_data = df[df['Mode'] == mode]
-    ax2.plot(mode_data['Devices'], mode_data['Latency_ms'], 
-             marker='s', label=mode, color=colors[mode],
-             linewidth=2, alpha=0.8)
-
-ax2.set_xlabel('Number of Devices')
-ax2.set_ylabel('Latency (ms)')
-ax2.set_title('End-to-End Latency Comparison')
-ax2.grid(True, alpha=0.3)
-ax2.legend()
-ax2.set_xscale('log')
-
-# 3. Durée vie batterie
-ax3 = axes[1, 0]
-for mode in ['RAP', 'EDT', 'PUR']:
-    mode_data = df[df['Mode'] == mode]
-    ax3.plot(mode_data['Devices'], mode_data['BatteryLife_Years'], 
-             marker='^', label=mode, color=colors[mode],
-             linewidth=2, alpha=0.8)
-
-ax3.set_xlabel('Number of Devices')
-ax3.set_ylabel('Battery Life (years)')
-ax3.set_title('Estimated Battery Life')
-ax3.grid(True, alpha=0.3)
-ax3.legend()
-ax3.set_xscale('log')
-
-# 4. Amélioration relative PUR vs RAP
-ax4 = axes[1, 1]
-improvements = []
-
-for count in device_counts:
-    rap_energy = df[(df['Mode'] == 'RAP') & (df['Devices'] == count)]['Energy_J']
-    pur_energy = df[(df['Mode'] == 'PUR') & (df['Devices'] == count)]['Energy_J']
-    
-    if len(rap_energy) > 0 and len(pur_energy) > 0:
-        improvement = (rap_energy.values[0] - pur_energy.values[0]) / rap_energy.values[0] * 100
-        improvements.append(improvement)
-    else:
-        improvements.append(np.nan)
-
-ax4.bar(range(len(device_counts)), improvements, 
-        color='#2ECC71', alpha=0.7, edgecolor='black')
-ax4.set_xlabel('Number of Devices')
-ax4.set_ylabel('Energy Improvement (%)')
-ax4.set_title('PUR Energy Savings vs RAP')
-ax4.set_xticks(range(len(device_counts)))
-ax4.set_xticklabels([str(x) for x in device_counts])
-ax4.grid(True, alpha=0.3, axis='y')
-
-# Ajouter valeurs sur les barres
-for i, val in enumerate(improvements):
-    if not np.isnan(val):
-        ax4.text(i, val + 1, f'{val:.1f}%', ha='center', va='bottom', fontweight='bold')
-
-plt.tight_layout()
-plt.savefig('real_nbiot_simulation_results.png', dpi=300, bbox_inches='tight')
-
-print("Graphs generated: real_nbiot_simulation_results.png")
-print("\nKey findings from REAL simulations:")
-print("1. Results vary with each simulation run")
-print("2. Error bars show measurement uncertainty")
-print("3. PUR consistently outperforms RAP and EDT")
-print("4. Improvements are statistically significant")
-
-# Générer un rapport
-with open('simulation_report.txt', 'w') as report:
-    report.write("REAL NB-IoT SIMULATION REPORT\n")
-    report.write("="*40 + "\n\n")
-    
-    for mode in ['RAP', 'EDT', 'PUR']:
-        mode_data = df[df['Mode'] == mode]
-        report.write(f"Mode: {mode}\n")
-        report.write(f"Average energy: {mode_data['Energy_J'].mean():.2f} J\n")
-        report.write(f"Average latency: {mode_data['Latency_ms'].mean():.0f} ms\n")
-        report.write(f"Average battery life: {mode_data['BatteryLife_Years'].mean():.1f} years\n\n")
-    
-    report.write("CONCLUSION:\n")
-    report.write("These are REAL simulation results with natural variation.\n")
-    report.write("Each run produces different but consistent patterns.\n")
-    report.write("PUR provides the best performance across all metrics.\n")
-
-print("\nReport generated: simulation_report.txt")
-
-plt.show()
-)";
+    // Dimensionnement PUR : plan de la première réplication de chaque cellule
+    // PUR (celui que suit --engine des), attente jusqu'à la ressource, et
+    // coût d'un re-plan où un UE sur dix quitte puis rejoint la cellule
+    void planPurResources() {
+        NBIOT_PROFILE_SCOPE("purPlan");
+        const AccessConfig& c = accessConfig;
+        std::cout << "\n========================================" << std::endl;
+        std::cout << "PUR RESOURCE PLAN (" << c.purTones << " tones, " << c.purDataMs << " ms slots, "
+                  << c.reportingPeriodMs / 1000.0 << " s period)" << std::endl;
+        std::cout << "========================================" << std::endl;
         
-        pyScript.close();
+        std::ofstream csvFile(outputPath("pur_plan.csv"));
+        csvFile << "Mode,Devices,Resources,Served,Unserved,Occupancy_Pct,Mean_Wait_ms,P95_Wait_ms,"
+                << "Plan_ms,Replan_ns_per_UE\n";
+        for (const auto& mode : modes) {
+            if (ModeRegistry::instance().get(mode).procedure != AccessProcedure::Preconfigured) continue;
+            for (int numDevices : deviceCounts) {
+                SweepCell cell{mode, numDevices, 0};
+                auto start = std::chrono::steady_clock::now();
+                PurPlan plan = AccessEngine::planPur(c, replicationSeed(cell), numDevices, isAntithetic(0));
+                double planMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                
+                RunningStats wait;
+                QuantileSketch waitSketch;
+                for (int id = 0; id < numDevices; id++) {
+                    if (plan.offsets[id] < 0) continue;
+                    double ms = (plan.offsets[id] - plan.ready[id]) * 1e-3;
+                    wait.add(ms);
+                    waitSketch.add(ms);
+                }
+                
+                // Re-plan incrémental : les autres UE gardent leur ressource
+                const int64_t slot = static_cast<int64_t>(std::llround(c.purDataMs * 1000.0));
+                int churned = 0;
+                start = std::chrono::steady_clock::now();
+                for (int id = 0; id < numDevices; id += 10) {
+                    plan.planner.release(static_cast<uint32_t>(id));
+                    churned++;
+                }
+                for (int id = 0; id < numDevices; id += 10) {
+                    plan.planner.assign(static_cast<uint32_t>(id),
+                                        static_cast<uint32_t>((plan.ready[id] + slot - 1) / slot));
+                }
+                double replanNs = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count() / std::max(churned, 1);
+                
+                uint64_t served = wait.count();
+                double occupancy = 100.0 * served / plan.planner.capacity();
+                std::cout << "  " << mode << " " << numDevices << " devices: " << served << " served, "
+                          << numDevices - served << " fall back to EDT | " << occupancy << "% of "
+                          << plan.planner.capacity() << " resources | wait mean " << wait.mean()
+                          << " ms, p95 " << waitSketch.quantile(0.95) << " ms | planned in " << planMs
+                          << " ms" << std::endl;
+                csvFile << mode << "," << numDevices << "," << plan.planner.capacity() << "," << served << ","
+                        << numDevices - served << "," << occupancy << "," << wait.mean() << ","
+                        << waitSketch.quantile(0.95) << "," << planMs << "," << replanNs << "\n";
+            }
+        }
+        std::cout << "PUR plan -> " << outputPath("pur_plan.csv") << std::endl;
+    }
+    
+    void generateGraphs(const std::vector<SimulationResult>& results) {
+        NBIOT_PROFILE_SCOPE("generateGraphs");
+        // Graphiques et rapport générés directement depuis les résultats en mémoire
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Report::Row> rows;
+        for (const auto& res : results) {
+            rows.push_back({res.mode, res.numDevices, res.avgEnergy, res.energyStdDev,
+                            res.avgLatency, res.batteryLife});
+        }
+        Report::writeReport(rows, outputPath("real_nbiot_simulation_results.svg"),
+                            outputPath("real_nbiot_simulation_results.html"), outputPath("simulation_report.txt"));
         
-        std::cout << "\nRunning Python to generate graphs..." << std::endl;
-        system("python3 generate_graphs.py");
+        double milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nGraphs generated: " << outputPath("real_nbiot_simulation_results.svg") << " / .html ("
+                  << milliseconds << " ms)" << std::endl;
+        std::cout << "Report generated: " << outputPath("simulation_report.txt") << std::endl;
     }
 };
 
-int main() {
+// simulation-benchmark.cpp inclut ce fichier sans son point d'entrée
+#ifndef NBIOT_SIMULATOR_NO_MAIN
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--threads N] [--seed S] [--keep-samples]"
+              << " [--kernel auto|scalar|avx2|avx512] [--modes M1,M2,...]"
+              << " [--engine closed-form|des] [--sim-days D]"
+              << " [--interference uniform|spatial] [--coverage distance|ce] [--pur-plan [--pur-tones N]]"
+              << " [--trace FILE [--trace-compress]] [--profile FILE]"
+              << " [--devices LIST] [--cache DIR [--cache-prune]]"
+              << " [--repeats N] [--ci-target X [--max-repeats N]] [--crn] [--antithetic] [--bootstrap B]"
+              << " [--shard I/N] [--output-dir DIR] [--stream TARGET [--stream-progress S]]"
+              << " [--lifetime [--lifetime-years Y] [--traffic periodic|poisson|diurnal]"
+              << " [--reports-per-day R] [--battery-wh WH] [--psm-current UA] [--edrx-cycle S]"
+              << " [--tau-hours H]]" << std::endl;
+    std::cout << "       " << program << " [--output-dir DIR] --merge SHARD..." << std::endl;
+    std::cout << "       " << program << " --seed S [model options] --replay MODE:DEVICES:REPEAT:ID[,ID...]..."
+              << std::endl;
+    std::cout << "       " << program << " [--seed S] [--devices LIST] [model options] --sensitivity N" << std::endl;
+    std::cout << "       " << program << " --export-csv TRACE CSV" << std::endl;
+    std::cout << "  --threads N   worker threads for the sweep (default: all cores)" << std::endl;
+    std::cout << "  --seed S      master seed; identical seeds give identical results" << std::endl;
+    std::cout << "  --keep-samples  keep every per-device value in memory" << std::endl;
+    std::cout << "  --kernel K    force a device kernel (default: best supported)" << std::endl;
+    std::cout << "  --modes LIST  comma-separated modes to sweep (default: RAP,EDT,PUR)" << std::endl;
+    std::cout << "  --engine E    closed-form model or discrete-event access engine (des)" << std::endl;
+    std::cout << "  --sim-days D  simulated days per cell with --engine des (default: 1)" << std::endl;
+    std::cout << "  --interference M  uniform cell load or spatial neighbours (default: uniform)" << std::endl;
+    std::cout << "  --coverage M  linear distance penalty or CE-level link budget (default: distance)" << std::endl;
+    std::cout << "  --pur-plan    plan dedicated PUR slots; --engine des transmits in them" << std::endl;
+    std::cout << "  --pur-tones N  subcarriers reserved for PUR, out of 12 (default: 6)" << std::endl;
+    std::cout << "  --trace FILE  write every device to a columnar binary trace" << std::endl;
+    std::cout << "  --trace-compress  compress trace columns (delta + byte shuffle + RLE)" << std::endl;
+    std::cout << "  --devices LIST  comma-separated cell sizes (default: 100,500,1000,5000,10000)" << std::endl;
+    std::cout << "  --cache DIR   reuse cells computed by earlier runs, store the new ones" << std::endl;
+    std::cout << "  --cache-prune  delete cached cells of other model versions" << std::endl;
+    std::cout << "  --repeats N   replications per cell without --ci-target, pairs with --antithetic (default: 3)"
+              << std::endl;
+    std::cout << "  --ci-target X  replicate each cell until the 95% CI half-width is X of the mean" << std::endl;
+    std::cout << "  --max-repeats N  replication budget per cell with --ci-target (default: 200)" << std::endl;
+    std::cout << "  --bootstrap B  bootstrap replicates of the BCa intervals, 0 for none (default: 1000)"
+              << std::endl;
+    std::cout << "  --crn         common random numbers: all modes share each replication's draws" << std::endl;
+    std::cout << "  --antithetic  replicate in antithetic pairs (u and 1 - u)" << std::endl;
+    std::cout << "  --shard I/N   simulate every N-th cell from cell I and write its partial state" << std::endl;
+    std::cout << "  --output-dir DIR  write results (or the shard state) into DIR (default: .)" << std::endl;
+    std::cout << "  --stream TARGET  stream results as NDJSON to - (stdout), a FIFO, a file or unix:PATH"
+              << std::endl;
+    std::cout << "  --stream-progress S  partial results of large cells every S seconds, 0 for none (default: 0.5)"
+              << std::endl;
+    std::cout << "  --merge SHARD...  combine the partial states of all N shards into the results" << std::endl;
+    std::cout << "  --lifetime    simulate each device's battery lifetime after the sweep" << std::endl;
+    std::cout << "  --lifetime-years Y  lifetime horizon (default: 10)" << std::endl;
+    std::cout << "  --traffic P   report traffic: periodic, poisson or diurnal (default: periodic)" << std::endl;
+    std::cout << "  --reports-per-day R  reports per device and day (default: 24)" << std::endl;
+    std::cout << "  --battery-wh WH  battery capacity (default: 5)" << std::endl;
+    std::cout << "  --psm-current UA  PSM sleep current in microamperes (default: 3)" << std::endl;
+    std::cout << "  --edrx-cycle S  eDRX paging cycle in seconds, 0 for PSM only (default: 0)" << std::endl;
+    std::cout << "  --tau-hours H  periodic TAU timer (T3412), 0 to disable (default: 54)" << std::endl;
+    std::cout << "  --profile FILE  time the sweep phases, write a Chrome trace and print a summary" << std::endl;
+    std::cout << "  --replay SPEC  recompute devices ID of replication REPEAT of the (MODE, DEVICES) cell"
+              << std::endl;
+    std::cout << "                 with the sweep's draws, print every factor and exit" << std::endl;
+    std::cout << "  --sensitivity N  Sobol indices of the model constants from N scrambled Sobol samples"
+              << std::endl;
+    std::cout << "                   (power of two) per cell size, then exit" << std::endl;
+    std::cout << "  --export-csv TRACE CSV  convert a trace to one CSV row per device and exit" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    RealisticSimulator simulator;
+    std::string tracePath;
+    bool compressTrace = false;
+    std::string cacheDirectory;
+    bool pruneCache = false;
+    double confidenceTarget = 0.0;
+    int maxRepeats = 200;
+    int fixedUnits = 3;
+    int bootstrapReplicates = 1000;
+    bool commonRandomNumbers = false;
+    bool antithetic = false;
+    std::vector<std::string> shardFiles;
+    bool lifetime = false;
+    LifetimeConfig lifetimeConfig;
+    bool purPlan = false;
+    int purTones = 6;
+    std::vector<RealisticSimulator::ReplayRequest> replays;
+    std::string streamTarget;
+    long sensitivitySamples = 0;
+    double streamProgress = 0.5;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            simulator.setThreadCount(static_cast<unsigned>(strtoul(argv[++i], nullptr, 10)));
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            simulator.setSeed(strtoull(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--keep-samples") == 0) {
+            simulator.setKeepSamples(true);
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            try {
+                simulator.setKernel(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--modes") == 0 && i + 1 < argc) {
+            std::vector<std::string> names;
+            std::stringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (ModeRegistry::instance().find(name) == nullptr) {
+                    std::cerr << "Unknown mode: " << name << std::endl;
+                    return 1;
+                }
+                names.push_back(name);
+            }
+            try {
+                simulator.setModes(names);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            try {
+                simulator.setEngine(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sim-days") == 0 && i + 1 < argc) {
+            simulator.setSimulatedDays(strtod(argv[++i], nullptr));
+        } else if (strcmp(argv[i], "--interference") == 0 && i + 1 < argc) {
+            try {
+                simulator.setInterferenceModel(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--coverage") == 0 && i + 1 < argc) {
+            try {
+                simulator.setCoverageModel(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--pur-plan") == 0) {
+            purPlan = true;
+        } else if (strcmp(argv[i], "--pur-tones") == 0 && i + 1 < argc) {
+            purTones = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--trace-compress") == 0) {
+            compressTrace = true;
+        } else if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            std::vector<int> counts;
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                int count = atoi(item.c_str());
+                if (count < 1) {
+                    std::cerr << "Invalid device count: " << item << std::endl;
+                    return 1;
+                }
+                counts.push_back(count);
+            }
+            simulator.setDeviceCounts(counts);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--cache-prune") == 0) {
+            pruneCache = true;
+        } else if (strcmp(argv[i], "--ci-target") == 0 && i + 1 < argc) {
+            confidenceTarget = strtod(argv[++i], nullptr);
+            if (!(confidenceTarget > 0.0)) {
+                std::cerr << "Invalid confidence target: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            fixedUnits = atoi(argv[++i]);
+            if (fixedUnits < 1) {
+                std::cerr << "Invalid replication count: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--max-repeats") == 0 && i + 1 < argc) {
+            maxRepeats = atoi(argv[++i]);
+            if (maxRepeats < 1) {
+                std::cerr << "Invalid replication budget: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bootstrap") == 0 && i + 1 < argc) {
+            bootstrapReplicates = atoi(argv[++i]);
+            if (bootstrapReplicates < 0) {
+                std::cerr << "Invalid bootstrap replicate count: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--crn") == 0) {
+            commonRandomNumbers = true;
+        } else if (strcmp(argv[i], "--antithetic") == 0) {
+            antithetic = true;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            unsigned index, count;
+            char extra;
+            if (sscanf(argv[++i], "%u/%u%c", &index, &count, &extra) != 2 || count < 1 || index >= count) {
+                std::cerr << "Invalid shard (expected I/N with 0 <= I < N): " << argv[i] << std::endl;
+                return 1;
+            }
+            simulator.setShard(index, count);
+        } else if (strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            try {
+                simulator.setOutputDirectory(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            streamTarget = argv[++i];
+        } else if (strcmp(argv[i], "--stream-progress") == 0 && i + 1 < argc) {
+            streamProgress = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--merge") == 0 && i + 1 < argc) {
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) shardFiles.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--lifetime") == 0) {
+            lifetime = true;
+        } else if (strcmp(argv[i], "--lifetime-years") == 0 && i + 1 < argc) {
+            lifetimeConfig.years = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--traffic") == 0 && i + 1 < argc) {
+            try {
+                lifetimeConfig.traffic = parseTrafficProfile(argv[++i]);
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--reports-per-day") == 0 && i + 1 < argc) {
+            lifetimeConfig.reportsPerDay = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--battery-wh") == 0 && i + 1 < argc) {
+            lifetimeConfig.batteryJ = strtod(argv[++i], nullptr) * 3600.0;
+        } else if (strcmp(argv[i], "--psm-current") == 0 && i + 1 < argc) {
+            lifetimeConfig.psmCurrentA = strtod(argv[++i], nullptr) * 1e-6;
+        } else if (strcmp(argv[i], "--edrx-cycle") == 0 && i + 1 < argc) {
+            lifetimeConfig.edrxCycleS = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--tau-hours") == 0 && i + 1 < argc) {
+            lifetimeConfig.tauPeriodS = strtod(argv[++i], nullptr) * 3600.0;
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            RealisticSimulator::ReplayRequest request;
+            std::stringstream spec(argv[++i]);
+            std::string devices, item;
+            if (!std::getline(spec, request.mode, ':') || !(spec >> request.numDevices) || spec.get() != ':'
+                || !(spec >> request.repeat) || spec.get() != ':' || !std::getline(spec, devices)
+                || request.numDevices < 1 || request.repeat < 0) {
+                std::cerr << "Invalid replay (expected MODE:DEVICES:REPEAT:ID[,ID...]): " << argv[i] << std::endl;
+                return 1;
+            }
+            std::stringstream list(devices);
+            while (std::getline(list, item, ',')) {
+                char* end = nullptr;
+                errno = 0;
+                const long device = strtol(item.c_str(), &end, 10);
+                if (item.empty() || *end != '\0' || errno == ERANGE || device < 0
+                    || device > std::numeric_limits<int>::max()) {
+                    std::cerr << "Invalid replay device id: \"" << item << "\" in " << argv[i] << std::endl;
+                    return 1;
+                }
+                request.devices.push_back(static_cast<int>(device));
+            }
+            replays.push_back(request);
+        } else if (strcmp(argv[i], "--sensitivity") == 0 && i + 1 < argc) {
+            sensitivitySamples = strtol(argv[++i], nullptr, 10);
+            if (sensitivitySamples < 2 || sensitivitySamples > (1L << 24)
+                || (sensitivitySamples & (sensitivitySamples - 1)) != 0) {
+                std::cerr << "Invalid Sobol sample count (expected a power of two): " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            simulator.setProfile(argv[++i]);
+        } else if (strcmp(argv[i], "--export-csv") == 0 && i + 2 < argc) {
+            try {
+                TraceReader reader(argv[i + 1]);
+                reader.exportCsv(argv[i + 2]);
+                std::cout << reader.totalRows() << " rows exported to " << argv[i + 2] << std::endl;
+            } catch (const std::exception& error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+            return 0;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    try {
+        simulator.setTrace(tracePath, compressTrace);
+        simulator.setCache(cacheDirectory, pruneCache);
+        simulator.setConfidenceTarget(confidenceTarget, maxRepeats);
+        simulator.setFixedUnits(fixedUnits);
+        simulator.setBootstrapReplicates(bootstrapReplicates);
+        simulator.setVarianceReduction(commonRandomNumbers, antithetic);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    if (purPlan) {
+        try {
+            simulator.setPurPlan(purTones);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    if (lifetime) {
+        try {
+            simulator.setLifetime(lifetimeConfig);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!streamTarget.empty() && replays.empty()) {
+        // Sur la sortie standard, seul le flux NDJSON reste : le journal passe sur stderr
+        if (streamTarget == "-") std::cout.rdbuf(std::cerr.rdbuf());
+        try {
+            simulator.setStream(streamTarget, streamProgress);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    if (sensitivitySamples > 0) {
+        try {
+            simulator.runSensitivityAnalysis(static_cast<uint32_t>(sensitivitySamples));
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!replays.empty()) {
+        try {
+            simulator.replayDevices(replays);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (!shardFiles.empty()) {
+        try {
+            simulator.mergeShards(shardFiles);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (simulator.isSharded() && confidenceTarget > 0.0) {
+        std::cerr << "--ci-target needs every replication in one process; it cannot be sharded" << std::endl;
+        return 1;
+    }
+    
     std::cout << "========================================" << std::endl;
     std::cout << "REALISTIC NB-IoT SIMULATION SYSTEM" << std::endl;
     std::cout << "========================================" << std::endl;
@@ -446,8 +2236,13 @@ int main() {
     std::cout << "4. Shows error bars and confidence intervals" << std::endl;
     std::cout << "========================================\n" << std::endl;
     
-    RealisticSimulator simulator;
-    simulator.runMultipleSimulations();
+    // Fichier de trace, cache ou sortie inaccessible : message et code 1
+    try {
+        simulator.runMultipleSimulations();
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
     
     std::cout << "\n========================================" << std::endl;
     std::cout << "SIMULATION COMPLETE!" << std::endl;
@@ -455,11 +2250,13 @@ int main() {
     std::cout << "Files created:" << std::endl;
     std::cout << "1. real_simulation_results.csv - Data" << std::endl;
     std::cout << "2. detailed_results.txt - Detailed analysis" << std::endl;
-    std::cout << "3. real_nbiot_simulation_results.png - Graphs" << std::endl;
-    std::cout << "4. generate_graphs.py - Python script" << std::endl;
+    std::cout << "3. real_nbiot_simulation_results.svg - Graphs" << std::endl;
+    std::cout << "4. real_nbiot_simulation_results.html - Graphs and summary table" << std::endl;
     std::cout << "5. simulation_report.txt - Final report" << std::endl;
     std::cout << "\nRun again to see DIFFERENT results!" << std::endl;
     std::cout << "========================================" << std::endl;
     
     return 0;
 }
+
+#endif // NBIOT_SIMULATOR_NO_MAIN
@@ -0,0 +1,132 @@
+/*
+ * Scrambled Sobol low-discrepancy sequence
+ *
+ * Point i of dimension d is the XOR of the direction numbers v_d[b] over the
+ * set bits b of i (direction numbers of Joe and Kuo, new-joe-kuo-6.21201,
+ * for the first kMaxDimensions dimensions). Any point can be computed on its
+ * own, so points are generated in parallel without shared state.
+ *
+ * Each dimension is scrambled with a hash-based nested uniform (Owen)
+ * permutation of its bits (Burley, "Practical Hash-based Owen Scrambling",
+ * JCGT 2020). The scramble keeps the stratification of the sequence, so the
+ * first 2^m points still hold one point per interval of width 2^-m in every
+ * dimension. It also makes every point uniformly distributed, so estimators
+ * built on the points are unbiased. Different seeds give independent
+ * randomisations.
+ */
+
+#ifndef NBIOT_SOBOL_SEQUENCE_H
+#define NBIOT_SOBOL_SEQUENCE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "random-streams.h"
+
+class SobolSequence {
+public:
+    static const int kMaxDimensions = 24;
+    static const int kBits = 32;
+
+    SobolSequence(int dimensions, uint64_t seed) : dimensions(dimensions) {
+        if (dimensions < 1 || dimensions > kMaxDimensions) {
+            throw std::invalid_argument("Sobol sequence supports 1 to 24 dimensions");
+        }
+        directions.assign(static_cast<size_t>(dimensions) * kBits, 0);
+        scrambleSeeds.resize(dimensions);
+        for (int d = 0; d < dimensions; d++) {
+            uint32_t* v = &directions[static_cast<size_t>(d) * kBits];
+            if (d == 0) {
+                // Première dimension : van der Corput en base 2
+                for (int b = 0; b < kBits; b++) v[b] = 1u << (kBits - 1 - b);
+            } else {
+                const Polynomial& p = kPolynomials[d - 1];
+                for (int b = 0; b < p.degree; b++) v[b] = p.initial[b] << (kBits - 1 - b);
+                for (int b = p.degree; b < kBits; b++) {
+                    v[b] = v[b - p.degree] ^ (v[b - p.degree] >> p.degree);
+                    for (int k = 1; k < p.degree; k++) {
+                        if ((p.coefficients >> (p.degree - 1 - k)) & 1) v[b] ^= v[b - k];
+                    }
+                }
+            }
+            scrambleSeeds[d] = static_cast<uint32_t>(RandomStreams::mixSeed(seed, static_cast<uint64_t>(d)));
+        }
+    }
+
+    int dimensionCount() const { return dimensions; }
+
+    // Point `index` dans ]0, 1[^dimensions
+    void point(uint32_t index, double* out) const {
+        for (int d = 0; d < dimensions; d++) {
+            const uint32_t* v = &directions[static_cast<size_t>(d) * kBits];
+            uint32_t x = 0;
+            for (uint32_t bits = index, b = 0; bits != 0; bits >>= 1, b++) {
+                if (bits & 1) x ^= v[b];
+            }
+            out[d] = RandomStreams::uniformFromBits(scramble(x, scrambleSeeds[d]));
+        }
+    }
+
+private:
+    // Polynôme primitif de degré `degree` (coefficients intermédiaires en
+    // binaire) et nombres de direction initiaux m_1..m_degree
+    struct Polynomial {
+        int degree;
+        uint32_t coefficients;
+        uint32_t initial[8];
+    };
+
+    static constexpr Polynomial kPolynomials[kMaxDimensions - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+        {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+        {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+        {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+    };
+
+    static uint32_t reverseBits(uint32_t x) {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+        x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    // Permutation de Laine-Karras sur les bits inversés : chaque bit n'est
+    // modifié qu'en fonction des bits de poids plus fort, comme un
+    // brouillage d'Owen
+    static uint32_t scramble(uint32_t x, uint32_t seed) {
+        x = reverseBits(x);
+        x += seed;
+        x ^= x * 0x6C50B47Cu;
+        x ^= x * 0xB82F1E52u;
+        x ^= x * 0xC7AFE638u;
+        x ^= x * 0x8D22F6E6u;
+        return reverseBits(x);
+    }
+
+    int dimensions;
+    std::vector<uint32_t> directions;      // kBits nombres de direction par dimension
+    std::vector<uint32_t> scrambleSeeds;
+};
+
+#endif // NBIOT_SOBOL_SEQUENCE_H
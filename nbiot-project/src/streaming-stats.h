@@ -0,0 +1,217 @@
+/*
+ * Constant-memory statistics for per-device results
+ *
+ * RunningStats keeps count, mean and M2 with Welford's update and merges
+ * partial results with Chan's formula. QuantileSketch is a log-linear
+ * histogram over positive values: buckets split every power of two into
+ * 2^kSubBucketBits slices, so any quantile is within 0.4% of the true value
+ * and merging two sketches is an exact bucket-wise sum, whatever the order.
+ */
+
+#ifndef NBIOT_STREAMING_STATS_H
+#define NBIOT_STREAMING_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+class RunningStats {
+public:
+    RunningStats() : n(0), mu(0.0), m2(0.0),
+                     minValue(std::numeric_limits<double>::infinity()),
+                     maxValue(-std::numeric_limits<double>::infinity()) {}
+
+    void add(double x) {
+        n++;
+        double delta = x - mu;
+        mu += delta / n;
+        m2 += delta * (x - mu);
+        minValue = std::min(minValue, x);
+        maxValue = std::max(maxValue, x);
+    }
+
+    void merge(const RunningStats& other) {
+        if (other.n == 0) return;
+        if (n == 0) {
+            *this = other;
+            return;
+        }
+        uint64_t total = n + other.n;
+        double delta = other.mu - mu;
+        mu += delta * static_cast<double>(other.n) / total;
+        m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+        n = total;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+
+    uint64_t count() const { return n; }
+    double mean() const { return mu; }
+    double sumOfSquaredDeviations() const { return m2; }
+    double min() const { return minValue; }
+    double max() const { return maxValue; }
+
+    // Variance de population (même convention que les écarts-types existants)
+    double variance() const { return n > 0 ? m2 / n : 0.0; }
+    double sampleVariance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stdDev() const { return std::sqrt(variance()); }
+
+    // Reconstruit un état sérialisé
+    static RunningStats fromMoments(uint64_t count, double mean, double m2,
+                                    double minValue, double maxValue) {
+        RunningStats stats;
+        stats.n = count;
+        stats.mu = mean;
+        stats.m2 = m2;
+        stats.minValue = minValue;
+        stats.maxValue = maxValue;
+        return stats;
+    }
+
+private:
+    uint64_t n;
+    double mu;
+    double m2;
+    double minValue;
+    double maxValue;
+};
+
+class QuantileSketch {
+public:
+    static const int kSubBucketBits = 7;
+
+    QuantileSketch() : firstBucket(0), nonPositive(0), total(0) {}
+
+    void add(double x) {
+        total++;
+        if (!(x > 0.0)) {
+            nonPositive++;
+            return;
+        }
+        // Chemin rapide : le seau existe déjà
+        int64_t index = bucketIndex(x);
+        uint64_t offset = static_cast<uint64_t>(index - firstBucket);
+        if (offset < counts.size()) {
+            counts[offset]++;
+            return;
+        }
+        grow(index);
+        counts[static_cast<size_t>(index - firstBucket)]++;
+    }
+
+    // Ajout d'un bloc : état local en registres (les compteurs uint64_t
+    // pourraient sinon aliaser total et la taille du vecteur)
+    void addAll(const double* values, int count) {
+        int i = 0;
+        while (i < count) {
+            uint64_t* data = counts.data();
+            uint64_t size = counts.size();
+            int64_t first = firstBucket;
+            int start = i;
+            for (; i < count; i++) {
+                double x = values[i];
+                uint64_t offset = static_cast<uint64_t>(bucketIndex(x) - first);
+                if (!(x > 0.0) || offset >= size) break;
+                data[offset]++;
+            }
+            total += i - start;
+
+            // Chemin lent : valeur non positive ou seau hors plage
+            if (i < count) add(values[i++]);
+        }
+    }
+
+    void merge(const QuantileSketch& other) {
+        total += other.total;
+        nonPositive += other.nonPositive;
+        if (other.counts.empty()) return;
+        if (counts.empty()) {
+            firstBucket = other.firstBucket;
+            counts = other.counts;
+            return;
+        }
+        int64_t first = std::min(firstBucket, other.firstBucket);
+        int64_t last = std::max(firstBucket + static_cast<int64_t>(counts.size()),
+                                other.firstBucket + static_cast<int64_t>(other.counts.size()));
+        if (first < firstBucket) {
+            counts.insert(counts.begin(), static_cast<size_t>(firstBucket - first), 0);
+            firstBucket = first;
+        }
+        counts.resize(static_cast<size_t>(last - first), 0);
+        for (size_t i = 0; i < other.counts.size(); i++) {
+            counts[static_cast<size_t>(other.firstBucket - firstBucket) + i] += other.counts[i];
+        }
+    }
+
+    uint64_t count() const { return total; }
+
+    // q dans [0, 1] ; renvoie le milieu du seau contenant le rang demandé
+    double quantile(double q) const {
+        if (total == 0) return 0.0;
+        q = std::min(1.0, std::max(0.0, q));
+        uint64_t rank = static_cast<uint64_t>(q * (total - 1));
+        if (rank < nonPositive) return 0.0;
+        uint64_t seen = nonPositive;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen > rank) return bucketMidpoint(firstBucket + static_cast<int64_t>(i));
+        }
+        return bucketMidpoint(firstBucket + static_cast<int64_t>(counts.size()) - 1);
+    }
+
+    // Valeur représentative d'un seau (son milieu)
+    static double bucketMidpoint(int64_t index) {
+        uint64_t low = static_cast<uint64_t>(index) << (52 - kSubBucketBits);
+        uint64_t high = static_cast<uint64_t>(index + 1) << (52 - kSubBucketBits);
+        double lowValue, highValue;
+        std::memcpy(&lowValue, &low, sizeof(lowValue));
+        std::memcpy(&highValue, &high, sizeof(highValue));
+        return 0.5 * (lowValue + highValue);
+    }
+
+    // Accès brut pour la sérialisation
+    int64_t firstBucketIndex() const { return firstBucket; }
+    uint64_t nonPositiveCount() const { return nonPositive; }
+    const std::vector<uint64_t>& bucketCounts() const { return counts; }
+
+    static QuantileSketch fromBuckets(int64_t firstBucket, uint64_t nonPositive,
+                                      const std::vector<uint64_t>& counts) {
+        QuantileSketch sketch;
+        sketch.firstBucket = firstBucket;
+        sketch.nonPositive = nonPositive;
+        sketch.counts = counts;
+        sketch.total = nonPositive;
+        for (uint64_t c : counts) sketch.total += c;
+        return sketch;
+    }
+
+private:
+    void grow(int64_t index) {
+        if (counts.empty()) {
+            firstBucket = index;
+            counts.assign(1, 0);
+        } else if (index < firstBucket) {
+            counts.insert(counts.begin(), static_cast<size_t>(firstBucket - index), 0);
+            firstBucket = index;
+        } else {
+            counts.resize(static_cast<size_t>(index - firstBucket + 1), 0);
+        }
+    }
+
+    // Exposant et premiers bits de mantisse : pas de log() par valeur
+    static int64_t bucketIndex(double x) {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return static_cast<int64_t>(bits >> (52 - kSubBucketBits));
+    }
+
+    int64_t firstBucket;
+    uint64_t nonPositive;
+    uint64_t total;
+    std::vector<uint64_t> counts;
+};
+
+#endif // NBIOT_STREAMING_STATS_H
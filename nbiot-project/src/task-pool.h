@@ -0,0 +1,204 @@
+/*
+ * Work-stealing task pool for the simulation sweeps
+ *
+ * Each participating thread owns a deque: it pushes and pops its own work
+ * at the back and steals from the front of the others. The thread calling
+ * wait() takes part in the work, so nested task groups (cells spawning
+ * device chunks) never deadlock, and a pool of one thread runs inline.
+ */
+
+#ifndef NBIOT_TASK_POOL_H
+#define NBIOT_TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class TaskPool {
+public:
+    class TaskGroup {
+    public:
+        TaskGroup() : pending(0) {}
+
+    private:
+        friend class TaskPool;
+        std::atomic<size_t> pending;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    // threadCount inclut le thread appelant (0 = tous les cœurs)
+    explicit TaskPool(unsigned threadCount = 0) : queued(0), stopping(false) {
+        if (threadCount == 0) threadCount = defaultThreadCount();
+        for (unsigned i = 0; i < threadCount; i++) {
+            queues.emplace_back(new WorkQueue());
+        }
+        for (unsigned i = 1; i < threadCount; i++) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    static unsigned defaultThreadCount() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    template <class F>
+    void submit(TaskGroup& group, F&& fn) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+
+        // Les tâches créées par un worker restent dans sa file (localité)
+        size_t index = currentPool() == this
+                     ? currentIndex()
+                     : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(Task{&group, std::function<void()>(std::forward<F>(fn))});
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+    // Attend la fin du groupe en exécutant des tâches pendant l'attente
+    void wait(TaskGroup& group) {
+        ThreadBinding binding(this);
+        while (group.pending.load(std::memory_order_acquire) > 0) {
+            if (!runOne(currentIndex())) std::this_thread::yield();
+        }
+        if (group.error) {
+            std::exception_ptr error = group.error;
+            group.error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Task {
+        TaskGroup* group;
+        std::function<void()> fn;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Associe le thread courant à une file du pool (file 0 pour l'appelant)
+    class ThreadBinding {
+    public:
+        explicit ThreadBinding(TaskPool* pool)
+            : previousPool(currentPool()), previousIndex(currentIndex()) {
+            if (previousPool != pool) {
+                currentPool() = pool;
+                currentIndex() = 0;
+            }
+        }
+        ~ThreadBinding() {
+            currentPool() = previousPool;
+            currentIndex() = previousIndex;
+        }
+
+    private:
+        TaskPool* previousPool;
+        size_t previousIndex;
+    };
+
+    static TaskPool*& currentPool() {
+        static thread_local TaskPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    bool tryPop(size_t self, Task& task) {
+        // D'abord sa propre file (LIFO), ensuite vol chez les autres (FIFO)
+        {
+            WorkQueue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            WorkQueue& victim = *queues[(self + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool runOne(size_t self) {
+        Task task;
+        if (!tryPop(self, task)) return false;
+        queued.fetch_sub(1, std::memory_order_relaxed);
+
+        try {
+            task.fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(task.group->errorMutex);
+            if (!task.group->error) task.group->error = std::current_exception();
+        }
+        task.group->pending.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void workerLoop(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+
+        while (true) {
+            if (runOne(index)) continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] {
+                return stopping || queued.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> queued;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+#endif // NBIOT_TASK_POOL_H
@@ -0,0 +1,199 @@
+/*
+ * Columnar binary trace format for per-device results
+ *
+ * A trace file is a header, a sequence of row groups, and a footer:
+ *
+ *   "NBTRACE\0" | version u32 | reserved u32
+ *   row group 0: one chunk per column, each starting on a 64-byte boundary
+ *   row group 1: ...
+ *   footer: columns (type, name), mode names, then per row group its row
+ *           count and, per column, offset / stored size / raw size / codec
+ *   footer offset u64 | "NBTRFOOT"
+ *
+ * Values are stored in native (little-endian) layout, so an uncompressed
+ * chunk can be used in place from a memory-mapped file. The optional
+ * ShuffleRle codec takes deltas of integer columns, splits values into byte
+ * planes and run-length encodes them. Device ids, cell sizes and float
+ * exponents shrink to a few bytes per chunk.
+ */
+
+#ifndef NBIOT_TRACE_FORMAT_H
+#define NBIOT_TRACE_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace TraceFormat {
+
+const char kHeaderMagic[8] = {'N', 'B', 'T', 'R', 'A', 'C', 'E', '\0'};
+const char kFooterMagic[8] = {'N', 'B', 'T', 'R', 'F', 'O', 'O', 'T'};
+const uint32_t kVersion = 2;    // 2 : colonne repeat sur 32 bits
+const size_t kHeaderSize = 16;
+const size_t kChunkAlignment = 64;
+
+enum class ColumnType : uint8_t { U8, U16, U32, F32, F64 };
+enum class Codec : uint8_t { None, ShuffleRle };
+
+inline size_t typeSize(ColumnType type) {
+    switch (type) {
+    case ColumnType::U8: return 1;
+    case ColumnType::U16: return 2;
+    case ColumnType::U32: return 4;
+    case ColumnType::F32: return 4;
+    default: return 8;
+    }
+}
+
+inline bool isInteger(ColumnType type) {
+    return type == ColumnType::U8 || type == ColumnType::U16 || type == ColumnType::U32;
+}
+
+// Colonnes d'une trace par appareil, dans l'ordre du fichier
+enum Column { kMode, kCellDevices, kRepeat, kDevice, kGridX, kGridY, kEnergy, kLatency, kColumnCount };
+
+struct ColumnSpec {
+    const char* name;
+    ColumnType type;
+};
+
+const ColumnSpec kColumns[kColumnCount] = {
+    {"mode", ColumnType::U8},           // indice dans la table des modes
+    {"cell_devices", ColumnType::U32},
+    {"repeat", ColumnType::U32},
+    {"device", ColumnType::U32},
+    {"x", ColumnType::F32},
+    {"y", ColumnType::F32},
+    {"energy_j", ColumnType::F64},
+    {"latency_ms", ColumnType::F64},
+};
+
+struct ChunkInfo {
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t rawSize;
+    Codec codec;
+};
+
+struct RowGroupInfo {
+    uint32_t rows;
+    std::vector<ChunkInfo> chunks;   // une par colonne
+};
+
+// Différences successives (entiers, modulo 2^n) : des identifiants qui se
+// suivent deviennent une suite de 1
+template <class T>
+inline void deltaEncode(uint8_t* bytes, size_t count) {
+    T previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        T value;
+        std::memcpy(&value, bytes + i * sizeof(T), sizeof(T));
+        T delta = static_cast<T>(value - previous);
+        std::memcpy(bytes + i * sizeof(T), &delta, sizeof(T));
+        previous = value;
+    }
+}
+
+template <class T>
+inline void deltaDecode(uint8_t* bytes, size_t count) {
+    T previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        T delta;
+        std::memcpy(&delta, bytes + i * sizeof(T), sizeof(T));
+        previous = static_cast<T>(previous + delta);
+        std::memcpy(bytes + i * sizeof(T), &previous, sizeof(T));
+    }
+}
+
+inline void applyDelta(ColumnType type, uint8_t* bytes, size_t count, bool encode) {
+    switch (type) {
+    case ColumnType::U8:
+        encode ? deltaEncode<uint8_t>(bytes, count) : deltaDecode<uint8_t>(bytes, count);
+        break;
+    case ColumnType::U16:
+        encode ? deltaEncode<uint16_t>(bytes, count) : deltaDecode<uint16_t>(bytes, count);
+        break;
+    case ColumnType::U32:
+        encode ? deltaEncode<uint32_t>(bytes, count) : deltaDecode<uint32_t>(bytes, count);
+        break;
+    default:
+        break;
+    }
+}
+
+// Octet de contrôle c : c < 128 → c + 1 octets littéraux suivent ;
+// c >= 128 → l'octet suivant est répété c - 126 fois (2 à 129)
+inline void runLengthEncode(const uint8_t* in, size_t size, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < 129 && in[i + run] == in[i]) run++;
+        if (run >= 2) {
+            out.push_back(static_cast<uint8_t>(run + 126));
+            out.push_back(in[i]);
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        size_t literal = 0;
+        while (i < size && literal < 128) {
+            if (i + 1 < size && in[i + 1] == in[i]) break;
+            i++;
+            literal++;
+        }
+        out.push_back(static_cast<uint8_t>(literal - 1));
+        out.insert(out.end(), in + start, in + start + literal);
+    }
+}
+
+inline void runLengthDecode(const uint8_t* in, size_t size, uint8_t* out, size_t outSize) {
+    size_t o = 0;
+    for (size_t i = 0; i < size;) {
+        uint8_t control = in[i++];
+        if (control < 128) {
+            size_t literal = control + 1u;
+            if (i + literal > size || o + literal > outSize) throw std::runtime_error("Corrupt trace chunk");
+            std::memcpy(out + o, in + i, literal);
+            i += literal;
+            o += literal;
+        } else {
+            size_t run = control - 126u;
+            if (i >= size || o + run > outSize) throw std::runtime_error("Corrupt trace chunk");
+            std::memset(out + o, in[i++], run);
+            o += run;
+        }
+    }
+    if (o != outSize) throw std::runtime_error("Corrupt trace chunk");
+}
+
+// raw : valeurs brutes (modifiées sur place par le delta)
+inline void compressChunk(ColumnType type, std::vector<uint8_t>& raw, std::vector<uint8_t>& out) {
+    size_t width = typeSize(type);
+    size_t count = raw.size() / width;
+    if (isInteger(type)) applyDelta(type, raw.data(), count, true);
+
+    std::vector<uint8_t> planes(raw.size());
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < width; b++) planes[b * count + i] = raw[i * width + b];
+    }
+    runLengthEncode(planes.data(), planes.size(), out);
+}
+
+inline void decompressChunk(ColumnType type, const uint8_t* stored, size_t storedSize,
+                            uint8_t* out, size_t rawSize) {
+    size_t width = typeSize(type);
+    size_t count = rawSize / width;
+    std::vector<uint8_t> planes(rawSize);
+    runLengthDecode(stored, storedSize, planes.data(), rawSize);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < width; b++) out[i * width + b] = planes[b * count + i];
+    }
+    if (isInteger(type)) applyDelta(type, out, count, false);
+}
+
+} // namespace TraceFormat
+
+#endif // NBIOT_TRACE_FORMAT_H
@@ -0,0 +1,206 @@
+/*
+ * Memory-mapped reader for columnar per-device traces (trace-format.h)
+ *
+ * The whole file is mapped read-only. Uncompressed column chunks are
+ * returned as pointers into the mapping: no copy, no parsing. Compressed
+ * chunks are decoded once into a buffer owned by the reader. exportCsv()
+ * turns a trace back into one text row per device.
+ */
+
+#ifndef NBIOT_TRACE_READER_H
+#define NBIOT_TRACE_READER_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trace-format.h"
+
+class TraceReader {
+public:
+    template <class T>
+    struct ColumnView {
+        const T* data;
+        size_t size;
+        const T& operator[](size_t i) const { return data[i]; }
+    };
+
+    explicit TraceReader(const std::string& path) : mapping(nullptr), length(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open trace file: " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat trace file: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) mapping = static_cast<const uint8_t*>(address);
+        }
+        ::close(fd);
+        if (mapping == nullptr) throw std::runtime_error("Cannot map trace file: " + path);
+
+        try {
+            parse();
+        } catch (...) {
+            munmap(const_cast<uint8_t*>(mapping), length);
+            throw;
+        }
+    }
+
+    ~TraceReader() {
+        if (mapping != nullptr) munmap(const_cast<uint8_t*>(mapping), length);
+    }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    size_t rowGroupCount() const { return groups.size(); }
+    size_t rows(size_t group) const { return groups[group].rows; }
+    const std::vector<std::string>& modeNames() const { return modes; }
+
+    uint64_t totalRows() const {
+        uint64_t total = 0;
+        for (const auto& group : groups) total += group.rows;
+        return total;
+    }
+
+    // T doit correspondre au type de la colonne (uint8_t, uint16_t, uint32_t, float, double)
+    template <class T>
+    ColumnView<T> column(size_t group, int column) {
+        const TraceFormat::ChunkInfo& chunk = groups[group].chunks[column];
+        if (sizeof(T) != TraceFormat::typeSize(TraceFormat::kColumns[column].type)) {
+            throw std::invalid_argument(std::string("Wrong type for trace column ")
+                                        + TraceFormat::kColumns[column].name);
+        }
+
+        const uint8_t* bytes = mapping + chunk.offset;
+        if (chunk.codec != TraceFormat::Codec::None) {
+            std::vector<uint8_t>& decoded = decodedChunks[std::make_pair(group, column)];
+            if (decoded.empty() && chunk.rawSize > 0) {
+                // operator new aligne sur 16 octets : assez pour tous les types
+                decoded.resize(chunk.rawSize);
+                TraceFormat::decompressChunk(TraceFormat::kColumns[column].type, bytes,
+                                             chunk.storedSize, decoded.data(), chunk.rawSize);
+            }
+            bytes = decoded.data();
+        }
+        return ColumnView<T>{reinterpret_cast<const T*>(bytes), groups[group].rows};
+    }
+
+    // Une ligne CSV par appareil
+    void exportCsv(const std::string& path) {
+        std::ofstream csv(path);
+        if (!csv) throw std::runtime_error("Cannot create " + path);
+        csv << "Mode,CellDevices,Repeat,Device,X,Y,Energy_J,Latency_ms\n";
+        csv.precision(17);
+        for (size_t g = 0; g < groups.size(); g++) {
+            auto mode = column<uint8_t>(g, TraceFormat::kMode);
+            auto cellDevices = column<uint32_t>(g, TraceFormat::kCellDevices);
+            auto repeat = column<uint32_t>(g, TraceFormat::kRepeat);
+            auto device = column<uint32_t>(g, TraceFormat::kDevice);
+            auto x = column<float>(g, TraceFormat::kGridX);
+            auto y = column<float>(g, TraceFormat::kGridY);
+            auto energy = column<double>(g, TraceFormat::kEnergy);
+            auto latency = column<double>(g, TraceFormat::kLatency);
+            for (size_t i = 0; i < mode.size; i++) {
+                csv << modes.at(mode[i]) << ',' << cellDevices[i] << ',' << repeat[i] << ','
+                    << device[i] << ',' << x[i] << ',' << y[i] << ','
+                    << energy[i] << ',' << latency[i] << '\n';
+            }
+            decodedChunks.clear();
+        }
+    }
+
+private:
+    template <class T>
+    T get(size_t& cursor, size_t end) const {
+        if (cursor + sizeof(T) > end) throw std::runtime_error("Truncated trace footer");
+        T value;
+        std::memcpy(&value, mapping + cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    std::string getString(size_t& cursor, size_t end) const {
+        size_t size = get<uint8_t>(cursor, end);
+        if (cursor + size > end) throw std::runtime_error("Truncated trace footer");
+        std::string text(reinterpret_cast<const char*>(mapping + cursor), size);
+        cursor += size;
+        return text;
+    }
+
+    void parse() {
+        const size_t trailer = sizeof(uint64_t) + sizeof(TraceFormat::kFooterMagic);
+        if (length < TraceFormat::kHeaderSize + trailer ||
+            std::memcmp(mapping, TraceFormat::kHeaderMagic, sizeof(TraceFormat::kHeaderMagic)) != 0 ||
+            std::memcmp(mapping + length - sizeof(TraceFormat::kFooterMagic), TraceFormat::kFooterMagic,
+                        sizeof(TraceFormat::kFooterMagic)) != 0) {
+            throw std::runtime_error("Not a trace file (or trace not closed)");
+        }
+        uint32_t version;
+        std::memcpy(&version, mapping + 8, sizeof(version));
+        if (version != TraceFormat::kVersion) {
+            throw std::runtime_error("Unsupported trace version " + std::to_string(version));
+        }
+
+        size_t end = length - trailer;
+        size_t cursor = end;
+        uint64_t footerOffset = get<uint64_t>(cursor, length);
+        if (footerOffset > end) throw std::runtime_error("Corrupt trace footer");
+        cursor = static_cast<size_t>(footerOffset);
+
+        uint32_t columnCount = get<uint32_t>(cursor, end);
+        if (columnCount != TraceFormat::kColumnCount) throw std::runtime_error("Unexpected trace columns");
+        for (uint32_t c = 0; c < columnCount; c++) {
+            uint8_t type = get<uint8_t>(cursor, end);
+            std::string name = getString(cursor, end);
+            if (type != static_cast<uint8_t>(TraceFormat::kColumns[c].type) ||
+                name != TraceFormat::kColumns[c].name) {
+                throw std::runtime_error("Unexpected trace column: " + name);
+            }
+        }
+
+        uint32_t modeCount = get<uint32_t>(cursor, end);
+        for (uint32_t m = 0; m < modeCount; m++) modes.push_back(getString(cursor, end));
+
+        uint64_t groupCount = get<uint64_t>(cursor, end);
+        for (uint64_t g = 0; g < groupCount; g++) {
+            TraceFormat::RowGroupInfo group;
+            group.rows = get<uint32_t>(cursor, end);
+            for (uint32_t c = 0; c < columnCount; c++) {
+                TraceFormat::ChunkInfo chunk;
+                chunk.offset = get<uint64_t>(cursor, end);
+                chunk.storedSize = get<uint64_t>(cursor, end);
+                chunk.rawSize = get<uint64_t>(cursor, end);
+                chunk.codec = static_cast<TraceFormat::Codec>(get<uint8_t>(cursor, end));
+                size_t width = TraceFormat::typeSize(TraceFormat::kColumns[c].type);
+                if (chunk.offset + chunk.storedSize > footerOffset ||
+                    chunk.rawSize != static_cast<uint64_t>(group.rows) * width) {
+                    throw std::runtime_error("Corrupt trace chunk index");
+                }
+                group.chunks.push_back(chunk);
+            }
+            groups.push_back(group);
+        }
+    }
+
+    const uint8_t* mapping;
+    size_t length;
+    std::vector<std::string> modes;
+    std::vector<TraceFormat::RowGroupInfo> groups;
+    std::map<std::pair<size_t, int>, std::vector<uint8_t>> decodedChunks;
+};
+
+#endif // NBIOT_TRACE_READER_H
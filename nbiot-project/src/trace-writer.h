@@ -0,0 +1,283 @@
+/*
+ * Background writer for columnar per-device traces (trace-format.h)
+ *
+ * Simulation threads append batches of rows to the active buffer. When it
+ * holds a full row group it is swapped with the pending buffer, and a
+ * background thread encodes and writes that one while the kernel keeps
+ * filling the other. A producer only waits when the writer is still busy
+ * with the previous row group, which bounds memory at two groups.
+ */
+
+#ifndef NBIOT_TRACE_WRITER_H
+#define NBIOT_TRACE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace-format.h"
+
+class TraceWriter {
+public:
+    // Un lot de lignes, colonne par colonne
+    struct Rows {
+        std::vector<uint8_t> mode;
+        std::vector<uint32_t> cellDevices;
+        std::vector<uint32_t> repeat;
+        std::vector<uint32_t> device;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<double> energy;
+        std::vector<double> latency;
+
+        size_t size() const { return device.size(); }
+
+        void clear() {
+            mode.clear(); cellDevices.clear(); repeat.clear(); device.clear();
+            x.clear(); y.clear(); energy.clear(); latency.clear();
+        }
+
+        void append(const Rows& other) {
+            mode.insert(mode.end(), other.mode.begin(), other.mode.end());
+            cellDevices.insert(cellDevices.end(), other.cellDevices.begin(), other.cellDevices.end());
+            repeat.insert(repeat.end(), other.repeat.begin(), other.repeat.end());
+            device.insert(device.end(), other.device.begin(), other.device.end());
+            x.insert(x.end(), other.x.begin(), other.x.end());
+            y.insert(y.end(), other.y.begin(), other.y.end());
+            energy.insert(energy.end(), other.energy.begin(), other.energy.end());
+            latency.insert(latency.end(), other.latency.begin(), other.latency.end());
+        }
+
+        // Octets bruts d'une colonne (TraceFormat::Column)
+        void column(int index, const uint8_t*& data, size_t& bytes) const {
+            switch (index) {
+            case TraceFormat::kMode: view(mode, data, bytes); break;
+            case TraceFormat::kCellDevices: view(cellDevices, data, bytes); break;
+            case TraceFormat::kRepeat: view(repeat, data, bytes); break;
+            case TraceFormat::kDevice: view(device, data, bytes); break;
+            case TraceFormat::kGridX: view(x, data, bytes); break;
+            case TraceFormat::kGridY: view(y, data, bytes); break;
+            case TraceFormat::kEnergy: view(energy, data, bytes); break;
+            default: view(latency, data, bytes); break;
+            }
+        }
+
+    private:
+        template <class T>
+        static void view(const std::vector<T>& values, const uint8_t*& data, size_t& bytes) {
+            data = reinterpret_cast<const uint8_t*>(values.data());
+            bytes = values.size() * sizeof(T);
+        }
+    };
+
+    explicit TraceWriter(const std::string& path,
+                         TraceFormat::Codec codec = TraceFormat::Codec::None,
+                         size_t rowsPerGroup = 65536)
+        : out(path, std::ios::binary | std::ios::trunc), codec(codec),
+          rowsPerGroup(rowsPerGroup), closed(false), rows(0), pendingFull(false),
+          stopping(false), failed(false), position(0) {
+        if (!out) throw std::runtime_error("Cannot open trace file: " + path);
+        char header[TraceFormat::kHeaderSize] = {};
+        std::memcpy(header, TraceFormat::kHeaderMagic, sizeof(TraceFormat::kHeaderMagic));
+        std::memcpy(header + 8, &TraceFormat::kVersion, sizeof(TraceFormat::kVersion));
+        write(header, sizeof(header));
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    ~TraceWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Indice d'un mode dans la table du pied de fichier
+    uint8_t modeIndex(const std::string& name) {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        for (size_t i = 0; i < modeNames.size(); i++) {
+            if (modeNames[i] == name) return static_cast<uint8_t>(i);
+        }
+        if (modeNames.size() == 256) throw std::runtime_error("Too many modes in one trace");
+        modeNames.push_back(name);
+        return static_cast<uint8_t>(modeNames.size() - 1);
+    }
+
+    // Appelable depuis plusieurs threads ; l'ordre des lots suit l'ordre d'appel
+    void append(const Rows& batch) {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        active.append(batch);
+        rows += batch.size();
+        if (active.size() >= rowsPerGroup) handOff();
+    }
+
+    uint64_t rowCount() const { return rows; }
+
+    // Vide les tampons et écrit le pied de fichier
+    void close() {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        if (closed) return;
+        closed = true;
+
+        if (active.size() > 0) handOff();
+        {
+            std::lock_guard<std::mutex> handoffLock(handoffMutex);
+            stopping = true;
+        }
+        handoffReady.notify_one();
+        writer.join();
+
+        writeFooter();
+        out.close();
+        if (failed || !out) throw std::runtime_error("Error while writing trace file");
+    }
+
+private:
+    void handOff() {
+        std::unique_lock<std::mutex> lock(handoffMutex);
+        handoffDone.wait(lock, [this] { return !pendingFull; });
+        std::swap(active, pending);
+        active.clear();
+        pendingFull = true;
+        lock.unlock();
+        handoffReady.notify_one();
+    }
+
+    void writerLoop() {
+        for (;;) {
+            std::unique_lock<std::mutex> lock(handoffMutex);
+            handoffReady.wait(lock, [this] { return pendingFull || stopping; });
+            if (!pendingFull) return;
+            lock.unlock();
+
+            writeRowGroup(pending);
+
+            lock.lock();
+            pendingFull = false;
+            lock.unlock();
+            handoffDone.notify_one();
+        }
+    }
+
+    void write(const void* data, size_t bytes) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        if (!out) failed = true;
+        position += bytes;
+    }
+
+    void align() {
+        static const char zeros[TraceFormat::kChunkAlignment] = {};
+        size_t padding = (TraceFormat::kChunkAlignment - position % TraceFormat::kChunkAlignment)
+                       % TraceFormat::kChunkAlignment;
+        write(zeros, padding);
+    }
+
+    void writeRowGroup(const Rows& group) {
+        TraceFormat::RowGroupInfo info;
+        info.rows = static_cast<uint32_t>(group.size());
+
+        for (int c = 0; c < TraceFormat::kColumnCount; c++) {
+            const uint8_t* data;
+            size_t bytes;
+            group.column(c, data, bytes);
+
+            TraceFormat::ChunkInfo chunk;
+            chunk.rawSize = bytes;
+            chunk.codec = TraceFormat::Codec::None;
+
+            if (codec == TraceFormat::Codec::ShuffleRle) {
+                scratch.assign(data, data + bytes);
+                encoded.clear();
+                TraceFormat::compressChunk(TraceFormat::kColumns[c].type, scratch, encoded);
+                if (encoded.size() < bytes) {
+                    chunk.codec = TraceFormat::Codec::ShuffleRle;
+                    data = encoded.data();
+                    bytes = encoded.size();
+                }
+            }
+
+            align();
+            chunk.offset = position;
+            chunk.storedSize = bytes;
+            write(data, bytes);
+            info.chunks.push_back(chunk);
+        }
+        groups.push_back(info);
+    }
+
+    template <class T>
+    static void put(std::vector<uint8_t>& buffer, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void putString(std::vector<uint8_t>& buffer, const std::string& text) {
+        put<uint8_t>(buffer, static_cast<uint8_t>(text.size()));
+        buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+
+    void writeFooter() {
+        std::vector<uint8_t> footer;
+        put<uint32_t>(footer, TraceFormat::kColumnCount);
+        for (const auto& column : TraceFormat::kColumns) {
+            put<uint8_t>(footer, static_cast<uint8_t>(column.type));
+            putString(footer, column.name);
+        }
+        put<uint32_t>(footer, static_cast<uint32_t>(modeNames.size()));
+        for (const auto& name : modeNames) putString(footer, name);
+
+        put<uint64_t>(footer, groups.size());
+        for (const auto& group : groups) {
+            put<uint32_t>(footer, group.rows);
+            for (const auto& chunk : group.chunks) {
+                put<uint64_t>(footer, chunk.offset);
+                put<uint64_t>(footer, chunk.storedSize);
+                put<uint64_t>(footer, chunk.rawSize);
+                put<uint8_t>(footer, static_cast<uint8_t>(chunk.codec));
+            }
+        }
+
+        align();
+        uint64_t footerOffset = position;
+        write(footer.data(), footer.size());
+        write(&footerOffset, sizeof(footerOffset));
+        write(TraceFormat::kFooterMagic, sizeof(TraceFormat::kFooterMagic));
+    }
+
+    std::ofstream out;
+    TraceFormat::Codec codec;
+    size_t rowsPerGroup;
+
+    // Côté producteurs
+    std::mutex appendMutex;
+    Rows active;
+    std::vector<std::string> modeNames;
+    bool closed;
+    uint64_t rows;
+
+    // Passage de relais vers le thread d'écriture
+    std::mutex handoffMutex;
+    std::condition_variable handoffReady;
+    std::condition_variable handoffDone;
+    Rows pending;
+    bool pendingFull;
+    bool stopping;
+    std::thread writer;
+
+    // Côté thread d'écriture (puis close(), après join)
+    bool failed;
+    uint64_t position;
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> encoded;
+    std::vector<TraceFormat::RowGroupInfo> groups;
+};
+
+#endif // NBIOT_TRACE_WRITER_H